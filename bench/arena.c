@@ -0,0 +1,102 @@
+#include "cs.h"
+
+#include <time.h>
+
+#define FILE_COUNT 4000
+#define ROUNDS 20
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static size_t run_malloc(const char *dir) {
+    char **entries = NULL;
+    size_t count = 0;
+    if (cs_list_dir(dir, &entries, &count) != 0) {
+        return 0;
+    }
+    size_t bytes = 0;
+    char path[4096];
+    for (size_t i = 0; i < count; i++) {
+        snprintf(path, sizeof(path), "%s/%s", dir, entries[i]);
+        cs_buffer buf = cs_read_file(path);
+        bytes += buf.len;
+        free(buf.data);
+        free(entries[i]);
+    }
+    free(entries);
+    return bytes;
+}
+
+static size_t run_arena(cs_arena *arena, const char *dir) {
+    char **entries = NULL;
+    size_t count = 0;
+    if (cs_list_dir_arena(arena, dir, &entries, &count) != 0) {
+        return 0;
+    }
+    size_t bytes = 0;
+    char path[4096];
+    for (size_t i = 0; i < count; i++) {
+        snprintf(path, sizeof(path), "%s/%s", dir, entries[i]);
+        bytes += cs_read_file_arena(arena, path).len;
+    }
+    cs_arena_reset(arena);
+    return bytes;
+}
+
+int main(void) {
+    char dir[] = "/tmp/cs-bench-arena-XXXXXX";
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    char path[4096];
+    char body[512];
+    memset(body, 'x', sizeof(body) - 1);
+    body[sizeof(body) - 1] = '\0';
+    for (int i = 0; i < FILE_COUNT; i++) {
+        snprintf(path, sizeof(path), "%s/file-%05d.txt", dir, i);
+        body[i % (sizeof(body) - 1)] = '\0';
+        cs_write_file(path, body);
+        body[i % (sizeof(body) - 1)] = 'x';
+    }
+
+    size_t expected = run_malloc(dir);
+
+    double start = now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        if (run_malloc(dir) != expected) {
+            fprintf(stderr, "malloc run mismatch\n");
+            return 1;
+        }
+    }
+    double malloc_ns = (now_ns() - start) / ROUNDS;
+
+    cs_arena arena;
+    cs_arena_init(&arena, 0);
+    start = now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        if (run_arena(&arena, dir) != expected) {
+            fprintf(stderr, "arena run mismatch\n");
+            return 1;
+        }
+    }
+    double arena_ns = (now_ns() - start) / ROUNDS;
+    cs_arena_free(&arena);
+
+    printf("arena: list+read %d files\n", FILE_COUNT);
+    printf("  malloc per entry: %10.0f ns/round %8.1f ns/file\n", malloc_ns,
+           malloc_ns / FILE_COUNT);
+    printf("  arena + reset:    %10.0f ns/round %8.1f ns/file (%.2fx)\n",
+           arena_ns, arena_ns / FILE_COUNT, malloc_ns / arena_ns);
+
+    for (int i = 0; i < FILE_COUNT; i++) {
+        snprintf(path, sizeof(path), "%s/file-%05d.txt", dir, i);
+        unlink(path);
+    }
+    rmdir(dir);
+    return 0;
+}
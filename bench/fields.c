@@ -0,0 +1,101 @@
+#include "cs.h"
+
+#include <time.h>
+
+#define TARGET_BYTES (64u * 1024u * 1024u)
+#define ROUNDS 5
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static size_t naive_count(const char *data, size_t len) {
+    size_t fields = 0;
+    int in_quotes = 0;
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+        if (c == '"') {
+            in_quotes = !in_quotes;
+        } else if (!in_quotes && (c == ',' || c == '\n')) {
+            fields++;
+        }
+    }
+    return fields;
+}
+
+static size_t cs_count(const char *data, size_t len) {
+    cs_fields parser;
+    cs_fields_init(&parser, data, len, ',');
+    cs_field fields[32];
+    size_t count = 0;
+    size_t total = 0;
+    while (cs_fields_row(&parser, fields, 32, &count) > 0) {
+        total += count;
+    }
+    return total;
+}
+
+int main(void) {
+    cs_out out;
+    char path[] = "/tmp/cs-bench-fields-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0 || cs_out_init(&out, fd) != 0) {
+        return 1;
+    }
+    uint64_t state = 2463534242ULL;
+    size_t rows = 0;
+    while ((size_t)lseek(fd, 0, SEEK_CUR) + out.len < TARGET_BYTES) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        cs_out_u64(&out, state % 1000000);
+        cs_out_str(&out, ",2026-10-18T12:00:00Z,");
+        cs_out_str(&out, state & 1 ? "\"GET /index.html, HTTP/1.1\"" : "POST");
+        cs_out_char(&out, ',');
+        cs_out_f64(&out, (double)(state % 100000) / 100.0, 2);
+        cs_out_str(&out, ",some-user-agent-string/1.0,");
+        cs_out_u64(&out, state % 512);
+        cs_out_char(&out, '\n');
+        rows++;
+    }
+    cs_out_close(&out);
+    close(fd);
+
+    cs_buffer buf = cs_read_file(path);
+    unlink(path);
+    if (!buf.data) {
+        return 1;
+    }
+
+    size_t naive = 0;
+    double start = now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        naive = naive_count(buf.data, buf.len);
+    }
+    double naive_ns = (now_ns() - start) / ROUNDS;
+
+    size_t fields = 0;
+    start = now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        fields = cs_count(buf.data, buf.len);
+    }
+    double cs_ns = (now_ns() - start) / ROUNDS;
+
+#if defined(__AVX2__)
+    const char *isa = "avx2";
+#elif defined(__SSE2__)
+    const char *isa = "sse2";
+#else
+    const char *isa = "scalar";
+#endif
+    printf("fields: %zu rows, %.1f MiB, scanner %s\n", rows,
+           (double)buf.len / (1024.0 * 1024.0), isa);
+    printf("  char loop:     %6.2f GB/s (%zu fields)\n", buf.len / naive_ns,
+           naive);
+    printf("  cs_fields_row: %6.2f GB/s (%zu fields)\n", buf.len / cs_ns,
+           fields);
+    free(buf.data);
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include "cs.h"
+
+#include <fnmatch.h>
+#include <time.h>
+
+#define COUNT 500000
+#define ROUNDS 4
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void run(const char *pattern, char (*paths)[64], const size_t *lens) {
+    size_t expected = 0;
+    double start = now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        expected = 0;
+        for (size_t i = 0; i < COUNT; i++) {
+            expected += fnmatch(pattern, paths[i], FNM_PATHNAME) == 0;
+        }
+    }
+    double fnmatch_ns = (now_ns() - start) / ((double)COUNT * ROUNDS);
+
+    size_t hits = 0;
+    cs_glob glob;
+    start = now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        if (r == 0 && cs_glob_compile(&glob, pattern) != 0) {
+            return;
+        }
+        hits = 0;
+        for (size_t i = 0; i < COUNT; i++) {
+            hits += (size_t)cs_glob_match(&glob, paths[i], lens[i]);
+        }
+    }
+    double glob_ns = (now_ns() - start) / ((double)COUNT * ROUNDS);
+    cs_glob_free(&glob);
+
+    printf("  %-22s fnmatch %6.1f ns/path, cs_glob_match %6.1f ns/path "
+           "(%.2fx)%s\n",
+           pattern, fnmatch_ns, glob_ns, fnmatch_ns / glob_ns,
+           hits == expected ? "" : " MISMATCH");
+}
+
+int main(void) {
+    static const char *dirs[] = {"src", "include", "tests", "vendor/lib",
+                                 "docs", "build/obj"};
+    static const char *exts[] = {".c", ".h", ".o", ".md", ".txt", ".cc"};
+    char (*paths)[64] = malloc((size_t)COUNT * sizeof(*paths));
+    size_t *lens = malloc((size_t)COUNT * sizeof(size_t));
+    if (!paths || !lens) {
+        return 1;
+    }
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < COUNT; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        lens[i] = (size_t)snprintf(paths[i], sizeof(paths[i]),
+                                   "%s/module_%04u%s", dirs[state % 6],
+                                   (unsigned)(state >> 8) % 10000,
+                                   exts[(state >> 32) % 6]);
+    }
+
+    printf("glob: %d paths, pattern compiled once\n", COUNT);
+    run("*/*.c", paths, lens);
+    run("src/module_[0-4]*.c", paths, lens);
+    run("*/*_*9*.[ch]", paths, lens);
+    free(paths);
+    free(lens);
+    return 0;
+}
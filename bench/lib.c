@@ -0,0 +1,974 @@
+#include "cs.h"
+
+#include <time.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+#define SMALL_BYTES (4 << 10)
+#define MEDIUM_BYTES (256 << 10)
+#define LARGE_BYTES (8 << 20)
+#define SMALL_ENTRIES 16
+#define MEDIUM_ENTRIES 512
+#define LARGE_ENTRIES 8192
+#define SIZES 3
+
+#if defined(__GLIBC__)
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static atomic_ulong bench_allocs;
+
+void *malloc(size_t size) {
+    atomic_fetch_add_explicit(&bench_allocs, 1, memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    atomic_fetch_add_explicit(&bench_allocs, 1, memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    atomic_fetch_add_explicit(&bench_allocs, 1, memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+#define BENCH_ALLOCS() atomic_load(&bench_allocs)
+#define BENCH_COUNTS_ALLOCS 1
+#else
+#define BENCH_ALLOCS() 0UL
+#define BENCH_COUNTS_ALLOCS 0
+#endif
+
+typedef struct {
+    const char *name;
+    const char *dataset;
+    int (*run)(size_t arg);
+    size_t arg;
+    size_t bytes;
+} bench_case;
+
+typedef struct {
+    char name[64];
+    char dataset[32];
+    double ns_per_op;
+} bench_baseline;
+
+static struct {
+    char dir[64];
+    char files[SIZES][128];
+    char lines[SIZES][128];
+    char scratch[128];
+    char dirs[SIZES][128];
+    char **many[SIZES];
+    char *text[SIZES];
+    char *csv[SIZES];
+    char *numbers[SIZES];
+    char *floats[SIZES];
+    char *json[SIZES];
+    char *json_doc[SIZES];
+    char **keys[SIZES];
+    cs_map maps[SIZES];
+    size_t sizes[SIZES];
+    size_t entries[SIZES];
+    char commands[SIZES][64];
+    char counts[SIZES][16];
+    int null_fd;
+    cs_pool *pool;
+    cs_arena arena;
+    cs_glob glob;
+    cs_glob walk_glob;
+    size_t sink;
+} env;
+
+static const char *byte_labels[SIZES] = {"4KiB", "256KiB", "8MiB"};
+static const char *entry_labels[SIZES] = {"16", "512", "8192"};
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static uint64_t next_random(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static char *make_text(size_t size, int kind, uint64_t *state) {
+    char *text = malloc(size + 64);
+    if (!text) {
+        return NULL;
+    }
+    size_t unique = size < MEDIUM_BYTES ? size : MEDIUM_BYTES;
+    size_t len = 0;
+    while (len < unique) {
+        uint64_t r = next_random(state);
+        int n = 0;
+        size_t room = size + 64 - len;
+        if (kind == 0) {
+            n = snprintf(text + len, room, "line %llu of synthetic text\n",
+                         (unsigned long long)(r % 1000000));
+        } else if (kind == 1) {
+            n = snprintf(text + len, room, "%llu,host%llu,\"a,b\",%u.%u\n",
+                         (unsigned long long)(r % 100000),
+                         (unsigned long long)(r >> 40), (unsigned)(r % 97),
+                         (unsigned)(r % 1000));
+        } else if (kind == 2) {
+            n = snprintf(text + len, room, "%lld\n",
+                         (long long)(r >> (r % 40)) - (long long)(r % 1000));
+        } else if (kind == 3) {
+            n = snprintf(text + len, room, "%.3f\n",
+                         (double)(r % 100000000) / 1000.0);
+        } else {
+            n = snprintf(text + len, room,
+                         "{\"id\":%llu,\"ok\":true,\"tags\":[\"x\",\"y\"],"
+                         "\"v\":%u.5}\n",
+                         (unsigned long long)(r % 100000),
+                         (unsigned)(r % 1000));
+        }
+        len += (size_t)n;
+    }
+    char *last = memrchr(text, '\n', unique);
+    size_t chunk = last ? (size_t)(last - text) + 1 : 0;
+    for (len = chunk; chunk && len + chunk <= size; len += chunk) {
+        memcpy(text + len, text, chunk);
+    }
+    memset(text + len, '\n', size - len);
+    text[size] = '\0';
+    return text;
+}
+
+static int run_read_file(size_t arg) {
+    cs_buffer buf = cs_read_file(env.files[arg]);
+    env.sink += buf.len;
+    free(buf.data);
+    return buf.len == env.sizes[arg] ? 0 : -1;
+}
+
+static int run_read_file_arena(size_t arg) {
+    cs_arena_reset(&env.arena);
+    cs_buffer buf = cs_read_file_arena(&env.arena, env.files[arg]);
+    env.sink += buf.len;
+    return buf.len == env.sizes[arg] ? 0 : -1;
+}
+
+static int run_map_file(size_t arg) {
+    cs_file_view view;
+    if (cs_map_file(env.files[arg], &view, 0) != 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < view.len; i += 4096) {
+        env.sink += (unsigned char)view.data[i];
+    }
+    cs_unmap_file(&view);
+    return 0;
+}
+
+static int run_lines(size_t arg) {
+    cs_reader reader;
+    cs_view line;
+    if (cs_lines_open(&reader, env.lines[arg]) != 0) {
+        return -1;
+    }
+    while (cs_reader_next(&reader, &line) == 1) {
+        env.sink += line.len;
+    }
+    cs_reader_close(&reader);
+    return 0;
+}
+
+static int run_write_file(size_t arg) {
+    return cs_write_file(env.scratch, env.text[arg]);
+}
+
+static int run_write_buffer(size_t arg) {
+    return cs_write_buffer(env.scratch, env.text[arg], env.sizes[arg]);
+}
+
+static int run_write_atomic(size_t arg) {
+    return cs_write_file_atomic(env.scratch, env.text[arg], env.sizes[arg]);
+}
+
+static int run_copy_file(size_t arg) {
+    return cs_copy_file(env.files[arg], env.scratch);
+}
+
+static int run_read_many(size_t arg) {
+    size_t count = env.entries[arg];
+    cs_buffer *results = calloc(count, sizeof(cs_buffer));
+    if (!results) {
+        return -1;
+    }
+    int rc = cs_read_many(env.many[arg], count, results, NULL);
+    for (size_t i = 0; i < count; i++) {
+        env.sink += results[i].len;
+        free(results[i].data);
+    }
+    free(results);
+    return rc;
+}
+
+static int run_list_dir(size_t arg) {
+    char **entries = NULL;
+    size_t count = 0;
+    if (cs_list_dir(env.dirs[arg], &entries, &count) != 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        free(entries[i]);
+    }
+    free(entries);
+    return count == env.entries[arg] ? 0 : -1;
+}
+
+static int run_list_dir_arena(size_t arg) {
+    char **entries = NULL;
+    size_t count = 0;
+    cs_arena_reset(&env.arena);
+    if (cs_list_dir_arena(&env.arena, env.dirs[arg], &entries, &count) != 0) {
+        return -1;
+    }
+    return count == env.entries[arg] ? 0 : -1;
+}
+
+static int count_entries(const cs_walk_entry *entries, size_t count,
+                         void *ctx) {
+    (void)entries;
+    atomic_fetch_add((atomic_size_t *)ctx, count);
+    return 0;
+}
+
+static int run_walk(size_t arg) {
+    atomic_size_t seen;
+    atomic_init(&seen, 0);
+    int rc = cs_walk(env.dirs[arg], NULL, count_entries, &seen);
+    return rc == 0 && atomic_load(&seen) == env.entries[arg] ? 0 : -1;
+}
+
+static int run_walk_glob(size_t arg) {
+    atomic_size_t seen;
+    atomic_init(&seen, 0);
+    int rc = cs_walk_glob(env.dirs[arg], NULL, &env.walk_glob, count_entries,
+                          &seen);
+    return rc == 0 && atomic_load(&seen) == env.entries[arg] / 2 ? 0 : -1;
+}
+
+static int run_cmd(size_t arg) {
+    (void)arg;
+    return cs_run_cmd("true");
+}
+
+static int run_cmd_capture(size_t arg) {
+    cs_buffer buf = cs_run_cmd_capture(env.commands[arg]);
+    free(buf.data);
+    return buf.len == env.sizes[arg] ? 0 : -1;
+}
+
+static int run_cmd_capture_arena(size_t arg) {
+    cs_arena_reset(&env.arena);
+    cs_buffer buf = cs_run_cmd_capture_arena(&env.arena, env.commands[arg]);
+    return buf.len == env.sizes[arg] ? 0 : -1;
+}
+
+static int run_many(size_t arg) {
+    (void)arg;
+    char *argv[] = {"true", NULL};
+    char **const argvs[16] = {argv, argv, argv, argv, argv, argv, argv, argv,
+                              argv, argv, argv, argv, argv, argv, argv, argv};
+    cs_cmd_result results[16];
+    int rc = cs_run_many(argvs, 16, 0, results);
+    for (size_t i = 0; i < 16; i++) {
+        rc |= results[i].status;
+        cs_cmd_result_free(&results[i]);
+    }
+    return rc;
+}
+
+static int run_capture(size_t arg) {
+    char *argv[] = {"head", "-c", env.counts[arg], "/dev/zero", NULL};
+    cs_cmd_result result;
+    int rc = cs_run_capture(argv, &result);
+    size_t len = result.out.len;
+    cs_cmd_result_free(&result);
+    return rc == 0 && len == env.sizes[arg] ? 0 : -1;
+}
+
+static int run_pipeline(size_t arg) {
+    char *head[] = {"head", "-c", env.counts[arg], "/dev/zero", NULL};
+    char *cat[] = {"cat", NULL};
+    char **const stages[] = {head, cat};
+    int statuses[2];
+    int rc = cs_pipeline(stages, 2, -1, env.null_fd, statuses);
+    return rc == 0 && statuses[0] == 0 && statuses[1] == 0 ? 0 : -1;
+}
+
+static int run_hash(size_t arg) {
+    env.sink += (size_t)cs_hash(env.text[arg], env.sizes[arg]);
+    return 0;
+}
+
+static int run_fields(size_t arg) {
+    cs_fields parser;
+    cs_field fields[16];
+    size_t count = 0;
+    cs_fields_init(&parser, env.csv[arg], env.sizes[arg], ',');
+    while (cs_fields_row(&parser, fields, 16, &count)) {
+        env.sink += count;
+    }
+    return 0;
+}
+
+static int run_parse_i64(size_t arg) {
+    const char *p = env.numbers[arg];
+    const char *end = p + env.sizes[arg];
+    while (p < end) {
+        int64_t value = 0;
+        size_t used = cs_parse_i64(p, (size_t)(end - p), &value);
+        env.sink += (size_t)value;
+        p += used + 1;
+    }
+    return 0;
+}
+
+static int run_parse_f64(size_t arg) {
+    const char *p = env.floats[arg];
+    const char *end = p + env.sizes[arg];
+    while (p < end) {
+        double value = 0;
+        size_t used = cs_parse_f64(p, (size_t)(end - p), &value);
+        env.sink += (size_t)value;
+        p += used + 1;
+    }
+    return 0;
+}
+
+static int run_json(size_t arg) {
+    cs_json json;
+    cs_json_token token;
+    cs_json_init(&json, env.json[arg], env.sizes[arg]);
+    int type = 0;
+    while ((type = cs_json_next(&json, &token)) > 0) {
+        env.sink += token.len;
+    }
+    return type == CS_JSON_END ? 0 : -1;
+}
+
+static int run_json_find(size_t arg) {
+    cs_json_token token;
+    int rc = cs_json_find(env.json_doc[arg], env.sizes[arg], "last", &token);
+    return rc == 0 && token.len == 1 ? 0 : -1;
+}
+
+static int run_out(size_t arg) {
+    cs_out out;
+    if (cs_out_init(&out, env.null_fd) != 0) {
+        return -1;
+    }
+    size_t count = env.sizes[arg] / 16;
+    for (size_t i = 0; i < count; i++) {
+        cs_out_u64(&out, (uint64_t)i * 2654435761u);
+        cs_out_char(&out, ' ');
+        cs_out_f64(&out, (double)i / 7.0, 3);
+        cs_out_char(&out, '\n');
+    }
+    return cs_out_close(&out);
+}
+
+static int run_map(size_t arg) {
+    cs_map map;
+    if (cs_map_init(&map, 0) != 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < env.entries[arg]; i++) {
+        const char *key = env.keys[arg][i];
+        uint64_t *value = cs_map_upsert(&map, key, strlen(key));
+        if (!value) {
+            cs_map_free(&map);
+            return -1;
+        }
+        *value += 1;
+    }
+    env.sink += map.count;
+    cs_map_free(&map);
+    return 0;
+}
+
+static int run_map_get(size_t arg) {
+    for (size_t i = 0; i < env.entries[arg]; i++) {
+        const char *key = env.keys[arg][i];
+        uint64_t *value = cs_map_get(&env.maps[arg], key, strlen(key));
+        if (!value) {
+            return -1;
+        }
+        env.sink += (size_t)*value;
+    }
+    return 0;
+}
+
+static int run_intern(size_t arg) {
+    cs_intern intern;
+    if (cs_intern_init(&intern, 0) != 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < env.entries[arg]; i++) {
+        const char *key = env.keys[arg][i];
+        if (!cs_intern_str(&intern, key, strlen(key))) {
+            cs_intern_free(&intern);
+            return -1;
+        }
+    }
+    env.sink += intern.map.count;
+    cs_intern_free(&intern);
+    return 0;
+}
+
+static int run_arena(size_t arg) {
+    cs_arena arena;
+    cs_arena_init(&arena, 0);
+    for (size_t i = 0; i < env.entries[arg]; i++) {
+        if (!cs_arena_strdup(&arena, env.keys[arg][i])) {
+            cs_arena_free(&arena);
+            return -1;
+        }
+    }
+    cs_arena_free(&arena);
+    return 0;
+}
+
+static int run_glob(size_t arg) {
+    for (size_t i = 0; i < env.entries[arg]; i++) {
+        const char *path = env.many[arg][i];
+        env.sink += (size_t)cs_glob_match(&env.glob, path, strlen(path));
+    }
+    return 0;
+}
+
+static atomic_size_t parallel_sum;
+
+static void sum_range(size_t begin, size_t end, int worker, void *ctx) {
+    (void)worker;
+    const unsigned char *data = (const unsigned char *)ctx;
+    size_t sum = 0;
+    for (size_t i = begin; i < end; i++) {
+        sum += data[i];
+    }
+    atomic_fetch_add_explicit(&parallel_sum, sum, memory_order_relaxed);
+}
+
+static int run_parallel_for(size_t arg) {
+    return cs_parallel_for(env.pool, env.sizes[arg], 4096, sum_range,
+                           env.text[arg]);
+}
+
+static int setup(int make_files) {
+    snprintf(env.dir, sizeof(env.dir), "/tmp/cs-bench-lib-XXXXXX");
+    if (!mkdtemp(env.dir)) {
+        return -1;
+    }
+    env.null_fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    env.pool = cs_pool_create(0);
+    cs_arena_init(&env.arena, 0);
+    if (env.null_fd < 0 || !env.pool ||
+        cs_glob_compile(&env.glob, "**/set-*/file-*[13579].txt") != 0 ||
+        cs_glob_compile(&env.walk_glob, "file-*[13579].txt") != 0) {
+        return -1;
+    }
+    snprintf(env.scratch, sizeof(env.scratch), "%s/scratch", env.dir);
+
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    const size_t *sizes = env.sizes;
+    const size_t *entries = env.entries;
+    for (int s = 0; s < SIZES; s++) {
+        env.text[s] = make_text(sizes[s], 0, &state);
+        env.csv[s] = make_text(sizes[s], 1, &state);
+        env.numbers[s] = make_text(sizes[s], 2, &state);
+        env.floats[s] = make_text(sizes[s], 3, &state);
+        env.json[s] = make_text(sizes[s], 4, &state);
+        env.json_doc[s] = malloc(sizes[s] + 64);
+        if (!env.text[s] || !env.csv[s] || !env.numbers[s] ||
+            !env.floats[s] || !env.json[s] || !env.json_doc[s]) {
+            return -1;
+        }
+        char *doc = env.json_doc[s];
+        const char *last = memrchr(env.json[s], '}', sizes[s] - 32);
+        size_t body = last ? (size_t)(last - env.json[s]) + 1 : 0;
+        memcpy(doc, "{\"rows\":[", 9);
+        memcpy(doc + 9, env.json[s], body);
+        for (size_t i = 9; i < 9 + body; i++) {
+            doc[i] = doc[i] == '\n' ? ',' : doc[i];
+        }
+        memcpy(doc + 9 + body, "],\"last\":1}", 12);
+        memset(doc + 21 + body, ' ', sizes[s] - 21 - body);
+        doc[sizes[s]] = '\0';
+        snprintf(env.files[s], sizeof(env.files[s]), "%s/data-%s.bin",
+                 env.dir, byte_labels[s]);
+        snprintf(env.lines[s], sizeof(env.lines[s]), "%s/lines-%s.txt",
+                 env.dir, byte_labels[s]);
+        if (cs_write_buffer(env.files[s], env.csv[s], sizes[s]) != 0 ||
+            cs_write_buffer(env.lines[s], env.text[s], sizes[s]) != 0) {
+            return -1;
+        }
+        snprintf(env.counts[s], sizeof(env.counts[s]), "%zu", sizes[s]);
+        snprintf(env.commands[s], sizeof(env.commands[s]),
+                 "head -c %zu /dev/zero", sizes[s]);
+
+        snprintf(env.dirs[s], sizeof(env.dirs[s]), "%s/set-%s", env.dir,
+                 entry_labels[s]);
+        if (make_files && mkdir(env.dirs[s], 0755) != 0) {
+            return -1;
+        }
+        env.many[s] = calloc(entries[s], sizeof(char *));
+        env.keys[s] = calloc(entries[s], sizeof(char *));
+        if (!env.many[s] || !env.keys[s] ||
+            cs_map_init(&env.maps[s], entries[s]) != 0) {
+            return -1;
+        }
+        for (size_t i = 0; i < entries[s]; i++) {
+            char path[256];
+            char key[32];
+            snprintf(path, sizeof(path), "%s/file-%05zu.txt", env.dirs[s], i);
+            snprintf(key, sizeof(key), "key-%llu",
+                     (unsigned long long)(next_random(&state) % 100000));
+            env.many[s][i] = strdup(path);
+            env.keys[s][i] = strdup(key);
+            uint64_t *count = cs_map_upsert(&env.maps[s], key, strlen(key));
+            if (!env.many[s][i] || !env.keys[s][i] || !count) {
+                return -1;
+            }
+            *count += 1;
+            if (make_files &&
+                cs_write_buffer(path, env.text[s] + (i % 64), 96) != 0) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+static void teardown(void) {
+    char *argv[] = {"rm", "-rf", env.dir, NULL};
+    cs_cmd_result result;
+    cs_run_capture(argv, &result);
+    cs_cmd_result_free(&result);
+    for (int s = 0; s < SIZES; s++) {
+        for (size_t i = 0; env.many[s] && i < env.entries[s]; i++) {
+            free(env.many[s][i]);
+            free(env.keys[s][i]);
+        }
+        free(env.many[s]);
+        free(env.keys[s]);
+        free(env.text[s]);
+        free(env.csv[s]);
+        free(env.numbers[s]);
+        free(env.floats[s]);
+        free(env.json[s]);
+        free(env.json_doc[s]);
+        cs_map_free(&env.maps[s]);
+    }
+    if (env.pool) {
+        cs_pool_destroy(env.pool);
+    }
+    cs_arena_free(&env.arena);
+    cs_glob_free(&env.glob);
+    cs_glob_free(&env.walk_glob);
+    if (env.null_fd >= 0) {
+        close(env.null_fd);
+    }
+}
+
+typedef struct {
+    int fds[3];
+    int enabled;
+} bench_perf;
+
+static void perf_open(bench_perf *perf) {
+    perf->enabled = 0;
+    perf->fds[0] = perf->fds[1] = perf->fds[2] = -1;
+#if defined(__linux__) && defined(__NR_perf_event_open)
+    static const uint64_t configs[3] = {PERF_COUNT_HW_CPU_CYCLES,
+                                        PERF_COUNT_HW_INSTRUCTIONS,
+                                        PERF_COUNT_HW_CACHE_MISSES};
+    for (int i = 0; i < 3; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[i];
+        attr.disabled = i == 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        perf->fds[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1,
+                                    i == 0 ? -1 : perf->fds[0], 0);
+        if (perf->fds[i] < 0) {
+            fprintf(stderr, "bench-lib: perf counters unavailable: %s\n",
+                    strerror(errno));
+            for (int j = 0; j < i; j++) {
+                close(perf->fds[j]);
+            }
+            return;
+        }
+    }
+    perf->enabled = 1;
+#else
+    fprintf(stderr, "bench-lib: perf counters need Linux\n");
+#endif
+}
+
+static void perf_start(bench_perf *perf) {
+#if defined(__linux__) && defined(__NR_perf_event_open)
+    if (perf->enabled) {
+        ioctl(perf->fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(perf->fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#else
+    (void)perf;
+#endif
+}
+
+static void perf_stop(bench_perf *perf, uint64_t counts[3]) {
+    counts[0] = counts[1] = counts[2] = 0;
+#if defined(__linux__) && defined(__NR_perf_event_open)
+    if (perf->enabled) {
+        uint64_t values[4] = {0, 0, 0, 0};
+        ioctl(perf->fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        if (read(perf->fds[0], values, sizeof(values)) ==
+            (ssize_t)sizeof(values)) {
+            counts[0] = values[1];
+            counts[1] = values[2];
+            counts[2] = values[3];
+        }
+    }
+#else
+    (void)perf;
+#endif
+}
+
+static size_t load_baseline(const char *path, bench_baseline **out) {
+    cs_buffer buf = cs_read_file(path);
+    size_t count = 0;
+    size_t cap = 0;
+    *out = NULL;
+    for (size_t i = 0; buf.data; i++) {
+        char key[64];
+        cs_json_token name;
+        cs_json_token dataset;
+        cs_json_token ns;
+        snprintf(key, sizeof(key), "cases.%zu.name", i);
+        if (cs_json_find(buf.data, buf.len, key, &name) != 0) {
+            break;
+        }
+        snprintf(key, sizeof(key), "cases.%zu.dataset", i);
+        int rc = cs_json_find(buf.data, buf.len, key, &dataset);
+        snprintf(key, sizeof(key), "cases.%zu.ns_per_op", i);
+        if (rc != 0 || cs_json_find(buf.data, buf.len, key, &ns) != 0 ||
+            name.type != CS_JSON_STRING || dataset.type != CS_JSON_STRING ||
+            ns.type != CS_JSON_NUMBER) {
+            continue;
+        }
+        if (count == cap) {
+            cap = cap ? cap * 2 : 64;
+            bench_baseline *next = realloc(*out, cap * sizeof(**out));
+            if (!next) {
+                break;
+            }
+            *out = next;
+        }
+        bench_baseline *entry = &(*out)[count++];
+        snprintf(entry->name, sizeof(entry->name), "%.*s", (int)name.len,
+                 name.data);
+        snprintf(entry->dataset, sizeof(entry->dataset), "%.*s",
+                 (int)dataset.len, dataset.data);
+        entry->ns_per_op = 0;
+        cs_parse_f64(ns.data, ns.len, &entry->ns_per_op);
+    }
+    free(buf.data);
+    return count;
+}
+
+static void json_number(cs_out *out, const char *key, double value,
+                        int present, int decimals) {
+    cs_out_str(out, ",\"");
+    cs_out_str(out, key);
+    cs_out_str(out, "\":");
+    if (present) {
+        cs_out_f64(out, value, decimals);
+    } else {
+        cs_out_str(out, "null");
+    }
+}
+
+static void usage(FILE *out, const char *argv0) {
+    fprintf(out,
+            "usage: %s [--json PATH] [--min-ms N] [--filter GLOB] [--perf]\n"
+            "       [--baseline PATH]\n",
+            argv0);
+}
+
+int main(int argc, char **argv) {
+    const char *json_path = NULL;
+    const char *filter = NULL;
+    const char *baseline_path = NULL;
+    double min_ms = 100;
+    int use_perf = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--perf") == 0) {
+            use_perf = 1;
+        } else if (i + 1 < argc && strcmp(argv[i], "--json") == 0) {
+            json_path = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--filter") == 0) {
+            filter = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--baseline") == 0) {
+            baseline_path = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--min-ms") == 0) {
+            const char *arg = argv[++i];
+            if (cs_parse_f64(arg, strlen(arg), &min_ms) == 0) {
+                usage(stderr, argv[0]);
+                return 2;
+            }
+        } else {
+            usage(stderr, argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 2;
+        }
+    }
+
+    cs_glob filter_glob;
+    if (filter && cs_glob_compile(&filter_glob, filter) != 0) {
+        fprintf(stderr, "bench-lib: bad filter: %s\n", filter);
+        return 2;
+    }
+    bench_baseline *baseline = NULL;
+    size_t baseline_count =
+        baseline_path ? load_baseline(baseline_path, &baseline) : 0;
+    bench_perf perf = {{-1, -1, -1}, 0};
+    if (use_perf) {
+        perf_open(&perf);
+    }
+    size_t sizes[SIZES] = {SMALL_BYTES, MEDIUM_BYTES, LARGE_BYTES};
+    size_t entries[SIZES] = {SMALL_ENTRIES, MEDIUM_ENTRIES, LARGE_ENTRIES};
+    memcpy(env.sizes, sizes, sizeof(sizes));
+    memcpy(env.entries, entries, sizeof(entries));
+    env.null_fd = -1;
+
+    struct {
+        const char *name;
+        int (*run)(size_t arg);
+        int by_entries;
+    } kinds[] = {
+        {"cs_read_file", run_read_file, 0},
+        {"cs_read_file_arena", run_read_file_arena, 0},
+        {"cs_map_file", run_map_file, 0},
+        {"cs_reader_next", run_lines, 0},
+        {"cs_write_file", run_write_file, 0},
+        {"cs_write_buffer", run_write_buffer, 0},
+        {"cs_write_file_atomic", run_write_atomic, 0},
+        {"cs_copy_file", run_copy_file, 0},
+        {"cs_read_many", run_read_many, 1},
+        {"cs_list_dir", run_list_dir, 1},
+        {"cs_list_dir_arena", run_list_dir_arena, 1},
+        {"cs_walk", run_walk, 1},
+        {"cs_walk_glob", run_walk_glob, 1},
+        {"cs_run_cmd", run_cmd, -1},
+        {"cs_run_many", run_many, -1},
+        {"cs_run_cmd_capture", run_cmd_capture, 0},
+        {"cs_run_cmd_capture_arena", run_cmd_capture_arena, 0},
+        {"cs_run_capture", run_capture, 0},
+        {"cs_pipeline", run_pipeline, 0},
+        {"cs_hash", run_hash, 0},
+        {"cs_fields_row", run_fields, 0},
+        {"cs_parse_i64", run_parse_i64, 0},
+        {"cs_parse_f64", run_parse_f64, 0},
+        {"cs_json_next", run_json, 0},
+        {"cs_json_find", run_json_find, 0},
+        {"cs_out", run_out, 0},
+        {"cs_map_upsert", run_map, 1},
+        {"cs_map_get", run_map_get, 1},
+        {"cs_intern_str", run_intern, 1},
+        {"cs_arena_strdup", run_arena, 1},
+        {"cs_glob_match", run_glob, 1},
+        {"cs_parallel_for", run_parallel_for, 0},
+    };
+    size_t kind_count = sizeof(kinds) / sizeof(kinds[0]);
+    bench_case *cases = calloc(kind_count * SIZES, sizeof(bench_case));
+    size_t case_count = 0;
+    for (size_t k = 0; cases && k < kind_count; k++) {
+        for (size_t s = 0; s < SIZES; s++) {
+            if (kinds[k].by_entries < 0 && s > 0) {
+                break;
+            }
+            bench_case *c = &cases[case_count];
+            c->name = kinds[k].name;
+            c->run = kinds[k].run;
+            c->arg = s;
+            c->dataset = kinds[k].by_entries < 0 ? "true"
+                         : kinds[k].by_entries  ? entry_labels[s]
+                                                : byte_labels[s];
+            c->bytes = kinds[k].by_entries ? 0 : env.sizes[s];
+            if (kinds[k].by_entries > 0 && c->run == run_read_many) {
+                c->bytes = env.entries[s] * 96;
+            }
+            char label[128];
+            snprintf(label, sizeof(label), "%s/%s", c->name, c->dataset);
+            if (!filter || cs_glob_match(&filter_glob, c->name,
+                                         strlen(c->name)) ||
+                cs_glob_match(&filter_glob, label, strlen(label))) {
+                case_count++;
+            }
+        }
+    }
+
+    int make_files = 0;
+    for (size_t i = 0; i < case_count; i++) {
+        make_files |= cases[i].run == run_read_many ||
+                      cases[i].run == run_list_dir ||
+                      cases[i].run == run_list_dir_arena ||
+                      cases[i].run == run_walk ||
+                      cases[i].run == run_walk_glob;
+    }
+    if (!cases || setup(make_files) != 0) {
+        fprintf(stderr, "bench-lib: setup failed in %s: %s\n", env.dir,
+                strerror(errno));
+        teardown();
+        return 1;
+    }
+
+    cs_out json;
+    int json_fd = -1;
+    if (json_path) {
+        json_fd = open(json_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                       0644);
+        if (json_fd < 0 || cs_out_init(&json, json_fd) != 0) {
+            fprintf(stderr, "bench-lib: cannot write %s: %s\n", json_path,
+                    strerror(errno));
+            teardown();
+            return 1;
+        }
+        cs_out_str(&json, "{\"min_ms\":");
+        cs_out_f64(&json, min_ms, 1);
+        cs_out_str(&json, ",\"allocs_counted\":");
+        cs_out_str(&json, BENCH_COUNTS_ALLOCS ? "true" : "false");
+        cs_out_str(&json, ",\"perf\":");
+        cs_out_str(&json, perf.enabled ? "true" : "false");
+        cs_out_str(&json, ",\"cases\":[");
+    }
+
+    printf("bench-lib: %zu cases, >= %.0f ms each%s\n", case_count, min_ms,
+           perf.enabled ? ", perf counters on" : "");
+    printf("  %-24s %-7s %12s %11s %10s", "primitive", "dataset", "ns/op",
+           "MB/s", "allocs/op");
+    if (perf.enabled) {
+        printf(" %12s %12s %10s", "cycles/op", "instr/op", "misses/op");
+    }
+    printf("%s\n", baseline_count ? "  vs baseline" : "");
+
+    int failed = 0;
+    for (size_t i = 0; i < case_count; i++) {
+        bench_case *c = &cases[i];
+        if (c->run(c->arg) != 0) {
+            fprintf(stderr, "bench-lib: %s/%s failed\n", c->name, c->dataset);
+            failed = 1;
+            continue;
+        }
+        unsigned long iterations = 1;
+        double elapsed = 0;
+        unsigned long allocs = 0;
+        uint64_t counts[3] = {0, 0, 0};
+        for (;;) {
+            allocs = BENCH_ALLOCS();
+            perf_start(&perf);
+            double start = now_ns();
+            for (unsigned long n = 0; n < iterations; n++) {
+                c->run(c->arg);
+            }
+            elapsed = now_ns() - start;
+            perf_stop(&perf, counts);
+            allocs = BENCH_ALLOCS() - allocs;
+            if (elapsed >= min_ms * 1e6 || iterations >= (1UL << 30)) {
+                break;
+            }
+            double scale = elapsed > 0 ? min_ms * 1e6 / elapsed : 100;
+            iterations = (unsigned long)((double)iterations *
+                                         (scale > 100 ? 100 : scale * 1.2)) +
+                         1;
+        }
+
+        double ns = elapsed / (double)iterations;
+        double mbps = c->bytes ? (double)c->bytes * 1e3 / ns : 0;
+        double allocs_per_op = (double)allocs / (double)iterations;
+        printf("  %-24s %-7s %12.1f ", c->name, c->dataset, ns);
+        if (c->bytes) {
+            printf("%11.1f", mbps);
+        } else {
+            printf("%11s", "-");
+        }
+        if (BENCH_COUNTS_ALLOCS) {
+            printf(" %10.1f", allocs_per_op);
+        } else {
+            printf(" %10s", "-");
+        }
+        if (perf.enabled) {
+            printf(" %12.0f %12.0f %10.1f", (double)counts[0] / iterations,
+                   (double)counts[1] / iterations,
+                   (double)counts[2] / iterations);
+        }
+        for (size_t b = 0; b < baseline_count; b++) {
+            if (strcmp(baseline[b].name, c->name) == 0 &&
+                strcmp(baseline[b].dataset, c->dataset) == 0 &&
+                baseline[b].ns_per_op > 0) {
+                printf("  %6.2fx", ns / baseline[b].ns_per_op);
+                break;
+            }
+        }
+        printf("\n");
+        fflush(stdout);
+
+        if (json_path) {
+            cs_out_str(&json, i ? ",{\"name\":\"" : "{\"name\":\"");
+            cs_out_str(&json, c->name);
+            cs_out_str(&json, "\",\"dataset\":\"");
+            cs_out_str(&json, c->dataset);
+            cs_out_str(&json, "\",\"iterations\":");
+            cs_out_u64(&json, iterations);
+            cs_out_str(&json, ",\"bytes_per_op\":");
+            cs_out_u64(&json, c->bytes);
+            json_number(&json, "ns_per_op", ns, 1, 2);
+            json_number(&json, "bytes_per_sec", mbps * 1e6, c->bytes != 0, 0);
+            json_number(&json, "allocs_per_op", allocs_per_op,
+                        BENCH_COUNTS_ALLOCS, 3);
+            json_number(&json, "cycles_per_op",
+                        (double)counts[0] / iterations, perf.enabled, 1);
+            json_number(&json, "instructions_per_op",
+                        (double)counts[1] / iterations, perf.enabled, 1);
+            json_number(&json, "cache_misses_per_op",
+                        (double)counts[2] / iterations, perf.enabled, 3);
+            cs_out_char(&json, '}');
+        }
+    }
+
+    if (json_path) {
+        cs_out_str(&json, "]}\n");
+        if (cs_out_close(&json) != 0) {
+            failed = 1;
+        }
+        close(json_fd);
+    }
+    for (int i = 0; i < 3; i++) {
+        if (perf.fds[i] >= 0) {
+            close(perf.fds[i]);
+        }
+    }
+    if (filter) {
+        cs_glob_free(&filter_glob);
+    }
+    free(baseline);
+    free(cases);
+    teardown();
+    return failed;
+}
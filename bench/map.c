@@ -0,0 +1,131 @@
+#include "cs.h"
+
+#include <time.h>
+
+#define OPS 4000000
+#define DISTINCT 250000
+
+typedef struct chain_node {
+    struct chain_node *next;
+    char *key;
+    uint64_t value;
+} chain_node;
+
+typedef struct {
+    chain_node **buckets;
+    size_t cap;
+} chain_map;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static uint64_t chain_hash(const char *key, size_t len) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)key[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static uint64_t *chain_upsert(chain_map *map, const char *key, size_t len) {
+    size_t index = chain_hash(key, len) % map->cap;
+    for (chain_node *node = map->buckets[index]; node; node = node->next) {
+        if (strncmp(node->key, key, len) == 0 && node->key[len] == '\0') {
+            return &node->value;
+        }
+    }
+    chain_node *node = (chain_node *)malloc(sizeof(chain_node));
+    node->key = strndup(key, len);
+    node->value = 0;
+    node->next = map->buckets[index];
+    map->buckets[index] = node;
+    return &node->value;
+}
+
+static void chain_free(chain_map *map) {
+    for (size_t i = 0; i < map->cap; i++) {
+        chain_node *node = map->buckets[i];
+        while (node) {
+            chain_node *next = node->next;
+            free(node->key);
+            free(node);
+            node = next;
+        }
+    }
+    free(map->buckets);
+}
+
+int main(void) {
+    char (*keys)[32] = malloc((size_t)OPS * sizeof(*keys));
+    size_t *lens = malloc((size_t)OPS * sizeof(size_t));
+    if (!keys || !lens) {
+        return 1;
+    }
+    uint64_t state = 88172645463325252ULL;
+    for (size_t i = 0; i < OPS; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        lens[i] = (size_t)snprintf(keys[i], sizeof(keys[i]), "host-%llu/path",
+                                   (unsigned long long)(state % DISTINCT));
+    }
+
+    chain_map chain = {calloc(65536, sizeof(chain_node *)), 65536};
+    double start = now_ns();
+    for (size_t i = 0; i < OPS; i++) {
+        (*chain_upsert(&chain, keys[i], lens[i]))++;
+    }
+    double chain_ns = (now_ns() - start) / OPS;
+
+    cs_map map;
+    cs_map_init(&map, 0);
+    start = now_ns();
+    for (size_t i = 0; i < OPS; i++) {
+        (*cs_map_upsert(&map, keys[i], lens[i]))++;
+    }
+    double map_ns = (now_ns() - start) / OPS;
+
+    uint64_t hits = 0;
+    start = now_ns();
+    for (size_t i = 0; i < OPS; i++) {
+        hits += *cs_map_get(&map, keys[i], lens[i]);
+    }
+    double get_ns = (now_ns() - start) / OPS;
+
+    cs_intern intern;
+    cs_intern_init(&intern, 0);
+    start = now_ns();
+    for (size_t i = 0; i < OPS; i++) {
+        hits += cs_intern_str(&intern, keys[i], lens[i]) != NULL;
+    }
+    double intern_ns = (now_ns() - start) / OPS;
+
+    start = now_ns();
+    uint64_t sink = 0;
+    for (size_t i = 0; i < OPS; i++) {
+        sink ^= cs_hash(keys[i], lens[i]);
+    }
+    double hash_ns = (now_ns() - start) / OPS;
+
+    printf("map: %d ops over %zu distinct keys\n", OPS, map.count);
+    printf("  chained fnv upsert: %6.1f ns/op\n", chain_ns);
+    printf("  cs_map_upsert:      %6.1f ns/op (%.2fx)\n", map_ns,
+           chain_ns / map_ns);
+    printf("  cs_map_get:         %6.1f ns/op\n", get_ns);
+    printf("  cs_intern_str:      %6.1f ns/op\n", intern_ns);
+    printf("  cs_hash:            %6.1f ns/op\n", hash_ns);
+    if (hits == 0 || sink == 0) {
+        return 1;
+    }
+
+    cs_intern_free(&intern);
+    cs_map_free(&map);
+    chain_free(&chain);
+    free(keys);
+    free(lens);
+    return 0;
+}
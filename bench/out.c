@@ -0,0 +1,49 @@
+#include "cs.h"
+
+#include <time.h>
+
+#define LINES 2000000
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+int main(void) {
+    FILE *sink = fopen("/dev/null", "w");
+    if (!sink) {
+        return 1;
+    }
+    double start = now_ns();
+    for (long i = 0; i < LINES; i++) {
+        fprintf(sink, "%ld\t%s\t%.3f\n", i * 7919, "GET", (double)i / 7.0);
+    }
+    fflush(sink);
+    double printf_ns = (now_ns() - start) / LINES;
+    fclose(sink);
+
+    int fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    cs_out out;
+    if (fd < 0 || cs_out_init(&out, fd) != 0) {
+        return 1;
+    }
+    start = now_ns();
+    for (long i = 0; i < LINES; i++) {
+        cs_out_i64(&out, i * 7919);
+        cs_out_char(&out, '\t');
+        cs_out_write(&out, "GET", 3);
+        cs_out_char(&out, '\t');
+        cs_out_f64(&out, (double)i / 7.0, 3);
+        cs_out_char(&out, '\n');
+    }
+    cs_out_flush(&out);
+    double out_ns = (now_ns() - start) / LINES;
+    cs_out_close(&out);
+    close(fd);
+
+    printf("out: %d lines of int, string and float\n", LINES);
+    printf("  fprintf:  %6.1f ns/line\n", printf_ns);
+    printf("  cs_out:   %6.1f ns/line (%.2fx)\n", out_ns, printf_ns / out_ns);
+    return 0;
+}
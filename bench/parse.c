@@ -0,0 +1,76 @@
+#include "cs.h"
+
+#include <time.h>
+
+#define COUNT 2000000
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+int main(void) {
+    char (*ints)[24] = malloc((size_t)COUNT * sizeof(*ints));
+    char (*floats)[32] = malloc((size_t)COUNT * sizeof(*floats));
+    size_t *int_lens = malloc((size_t)COUNT * sizeof(size_t));
+    size_t *float_lens = malloc((size_t)COUNT * sizeof(size_t));
+    if (!ints || !floats || !int_lens || !float_lens) {
+        return 1;
+    }
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < COUNT; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        int_lens[i] = cs_format_i64(ints[i], (int64_t)(state >> (state % 50)));
+        float_lens[i] = cs_format_f64(floats[i], sizeof(floats[i]),
+                                      (double)(state % 100000000) / 1000.0, 3);
+    }
+
+    int64_t isum = 0;
+    double start = now_ns();
+    for (size_t i = 0; i < COUNT; i++) {
+        ints[i][int_lens[i]] = '\0';
+        isum += strtoll(ints[i], NULL, 10);
+    }
+    double strtoll_ns = (now_ns() - start) / COUNT;
+
+    int64_t csum = 0;
+    start = now_ns();
+    for (size_t i = 0; i < COUNT; i++) {
+        int64_t value = 0;
+        cs_parse_i64(ints[i], int_lens[i], &value);
+        csum += value;
+    }
+    double parse_i64_ns = (now_ns() - start) / COUNT;
+
+    double fsum = 0;
+    start = now_ns();
+    for (size_t i = 0; i < COUNT; i++) {
+        fsum += strtod(floats[i], NULL);
+    }
+    double strtod_ns = (now_ns() - start) / COUNT;
+
+    double dsum = 0;
+    start = now_ns();
+    for (size_t i = 0; i < COUNT; i++) {
+        double value = 0;
+        cs_parse_f64(floats[i], float_lens[i], &value);
+        dsum += value;
+    }
+    double parse_f64_ns = (now_ns() - start) / COUNT;
+
+    printf("parse: %d integers and %d decimals\n", COUNT, COUNT);
+    printf("  strtoll:      %6.1f ns/op\n", strtoll_ns);
+    printf("  cs_parse_i64: %6.1f ns/op (%.2fx)%s\n", parse_i64_ns,
+           strtoll_ns / parse_i64_ns, isum == csum ? "" : " MISMATCH");
+    printf("  strtod:       %6.1f ns/op\n", strtod_ns);
+    printf("  cs_parse_f64: %6.1f ns/op (%.2fx)%s\n", parse_f64_ns,
+           strtod_ns / parse_f64_ns, fsum == dsum ? "" : " MISMATCH");
+    free(ints);
+    free(floats);
+    free(int_lens);
+    free(float_lens);
+    return 0;
+}
@@ -1,5 +1,8 @@
 #define _POSIX_C_SOURCE 200809L
 
+#include "cs.h"
+
+#include <ctype.h>
 #include <errno.h>
 #include <limits.h>
 #include <stdbool.h>
@@ -36,30 +39,18 @@ static void print_usage(FILE *out) {
                  "  -h, --help            Show this help\n");
 }
 
-static uint64_t fnv1a_update(uint64_t hash, const void *data, size_t len) {
-    const unsigned char *bytes = (const unsigned char *)data;
-    for (size_t i = 0; i < len; i++) {
-        hash ^= (uint64_t)bytes[i];
-        hash *= 1099511628211ULL;
-    }
-    return hash;
+static uint64_t hash_update(uint64_t hash, const void *data, size_t len) {
+    return cs_hash_seed(data, len, hash);
 }
 
-static uint64_t fnv1a_file(const char *path) {
-    FILE *file = fopen(path, "rb");
-    if (!file) {
+static uint64_t hash_file(const char *path) {
+    cs_file_view view;
+    if (cs_map_file(path, &view, 0) != 0) {
         return 0;
     }
-
-    uint64_t hash = 1469598103934665603ULL;
-    unsigned char buffer[8192];
-    size_t read_count = 0;
-    while ((read_count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
-        hash = fnv1a_update(hash, buffer, read_count);
-    }
-
-    fclose(file);
-    return hash;
+    uint64_t hash = cs_hash(view.data, view.len);
+    cs_unmap_file(&view);
+    return hash ? hash : 1;
 }
 
 static const char *path_basename(const char *path) {
@@ -260,6 +251,17 @@ static char *read_file_text(const char *path) {
     return buffer;
 }
 
+static bool source_includes_cs_header(const char *path) {
+    char *text = read_file_text(path);
+    if (!text) {
+        return false;
+    }
+    bool found = strstr(text, "\"cs.h\"") != NULL ||
+                 strstr(text, "<cs.h>") != NULL;
+    free(text);
+    return found;
+}
+
 static bool file_has_shebang(const char *path) {
     FILE *file = fopen(path, "rb");
     if (!file) {
@@ -332,45 +334,16 @@ static bool append_text_file(const char *path, const char *text) {
 }
 
 static char *json_find_string(const char *json, const char *key) {
-    size_t key_len = strlen(key);
-    size_t pattern_len = key_len + 4;
-    char *pattern = (char *)malloc(pattern_len);
-    if (!pattern) {
-        return NULL;
-    }
-    snprintf(pattern, pattern_len, "\"%s\"", key);
-
-    const char *pos = strstr(json, pattern);
-    free(pattern);
-    if (!pos) {
-        return NULL;
-    }
-    pos = strchr(pos, ':');
-    if (!pos) {
+    cs_json_token token;
+    if (cs_json_find(json, strlen(json), key, &token) != 0 ||
+        token.type != CS_JSON_STRING) {
         return NULL;
     }
-    pos++;
-    while (*pos == ' ' || *pos == '\t') {
-        pos++;
-    }
-    if (*pos != '"') {
-        return NULL;
-    }
-    pos++;
-    const char *end = pos;
-    while (*end && *end != '"') {
-        if (*end == '\\' && end[1]) {
-            end += 2;
-        } else {
-            end++;
-        }
-    }
-    size_t len = (size_t)(end - pos);
-    char *value = (char *)malloc(len + 1);
+    char *value = (char *)malloc(token.len + 1);
     if (!value) {
         return NULL;
     }
-    memcpy(value, pos, len);
+    size_t len = cs_json_unescape(&token, value);
     value[len] = '\0';
     return value;
 }
@@ -380,7 +353,28 @@ static bool parse_semver(const char *version, int *major, int *minor,
     if (!version || !major || !minor || !patch) {
         return false;
     }
-    return sscanf(version, "%d.%d.%d", major, minor, patch) == 3;
+    int *parts[3] = {major, minor, patch};
+    size_t len = strlen(version);
+    size_t pos = 0;
+    for (int i = 0; i < 3; i++) {
+        if (i > 0) {
+            if (pos >= len || version[pos] != '.') {
+                return false;
+            }
+            pos++;
+        }
+        while (pos < len && isspace((unsigned char)version[pos])) {
+            pos++;
+        }
+        uint64_t value = 0;
+        size_t used = cs_parse_u64(version + pos, len - pos, &value);
+        if (used == 0 || value > INT_MAX) {
+            return false;
+        }
+        *parts[i] = (int)value;
+        pos += used;
+    }
+    return true;
 }
 
 static int compare_versions(const char *current, const char *latest) {
@@ -718,17 +712,23 @@ int main(int argc, char **argv) {
         return 1;
     }
 
-    uint64_t hash = fnv1a_file(source_path);
+    if (source_includes_cs_header(source_path) &&
+        !append_flag(&ldflags, "-pthread")) {
+        fprintf(stderr, "Failed to set cs.h ldflags\n");
+        return 1;
+    }
+
+    uint64_t hash = hash_file(source_path);
     if (hash == 0) {
         fprintf(stderr, "Failed to read source file: %s\n", source_path);
         return 1;
     }
-    hash = fnv1a_update(hash, cc, strlen(cc));
+    hash = hash_update(hash, cc, strlen(cc));
     if (cflags) {
-        hash = fnv1a_update(hash, cflags, strlen(cflags));
+        hash = hash_update(hash, cflags, strlen(cflags));
     }
     if (ldflags) {
-        hash = fnv1a_update(hash, ldflags, strlen(ldflags));
+        hash = hash_update(hash, ldflags, strlen(ldflags));
     }
 
     const char *base = path_basename(source_path);
@@ -1,17 +1,91 @@
 #ifndef CS_H
 #define CS_H
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <locale.h>
+#include <math.h>
+#include <poll.h>
+#include <pthread.h>
+#include <spawn.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#if !defined(CS_NO_IO_URING) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <linux/stat.h>
+#define CS_HAVE_IO_URING 1
+#ifndef AT_EMPTY_PATH
+#define AT_EMPTY_PATH 0x1000
+#endif
+#endif
+#endif
+#endif
+
+#if defined(__linux__) && !defined(O_CLOEXEC) && defined(__O_CLOEXEC)
+#define O_CLOEXEC __O_CLOEXEC
+#define O_DIRECTORY __O_DIRECTORY
+#define AT_FDCWD -100
+#define AT_SYMLINK_NOFOLLOW 0x100
+#define F_DUPFD_CLOEXEC 1030
+char *strdup(const char *text);
+int openat(int dirfd, const char *path, int flags, ...);
+int fstatat(int dirfd, const char *path, struct stat *st, int flags);
+DIR *fdopendir(int fd);
+#endif
+
+#if defined(__linux__) && !defined(MADV_RANDOM)
+#define MADV_RANDOM 1
+#define MADV_SEQUENTIAL 2
+#define MADV_WILLNEED 3
+#define DT_UNKNOWN 0
+#define DT_DIR 4
+#define DT_REG 8
+#define DT_LNK 10
+#define MAP_POPULATE 0
+long syscall(long number, ...);
+int madvise(void *addr, size_t len, int advice);
+#endif
+
+extern char **environ;
 
 typedef struct {
     char *data;
     size_t len;
 } cs_buffer;
 
+typedef struct {
+    const char *data;
+    size_t len;
+} cs_view;
+
 static inline cs_buffer cs_read_file(const char *path) {
     cs_buffer result = {0};
     FILE *file = fopen(path, "rb");
@@ -43,22 +117,29 @@ static inline cs_buffer cs_read_file(const char *path) {
     return result;
 }
 
-static inline int cs_write_file(const char *path, const char *data) {
+static inline int cs_write_buffer(const char *path, const void *data,
+                                  size_t len) {
     FILE *file = fopen(path, "wb");
     if (!file) {
         return errno ? -errno : -1;
     }
-    size_t len = strlen(data);
     size_t written = fwrite(data, 1, len, file);
-    fclose(file);
-    if (written != len) {
+    if (fclose(file) != 0 || written != len) {
         return -1;
     }
     return 0;
 }
 
+static inline int cs_write_file(const char *path, const char *data) {
+    return cs_write_buffer(path, data, strlen(data));
+}
+
 static inline int cs_run_cmd(const char *cmd) { return system(cmd); }
 
+#ifndef CS_CAPTURE_CHUNK
+#define CS_CAPTURE_CHUNK (64 * 1024)
+#endif
+
 static inline cs_buffer cs_run_cmd_capture(const char *cmd) {
     cs_buffer result = {0};
     FILE *pipe = popen(cmd, "r");
@@ -66,16 +147,17 @@ static inline cs_buffer cs_run_cmd_capture(const char *cmd) {
         return result;
     }
 
-    size_t cap = 4096;
+    size_t cap = CS_CAPTURE_CHUNK;
     result.data = (char *)malloc(cap);
     if (!result.data) {
         pclose(pipe);
         return result;
     }
 
+    int fd = fileno(pipe);
     size_t len = 0;
-    while (!feof(pipe)) {
-        if (len + 1024 >= cap) {
+    for (;;) {
+        if (cap - len < CS_CAPTURE_CHUNK) {
             cap *= 2;
             char *next = (char *)realloc(result.data, cap);
             if (!next) {
@@ -87,8 +169,14 @@ static inline cs_buffer cs_run_cmd_capture(const char *cmd) {
             }
             result.data = next;
         }
-        size_t read_count = fread(result.data + len, 1, 1024, pipe);
-        len += read_count;
+        ssize_t read_count = read(fd, result.data + len, cap - len - 1);
+        if (read_count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (read_count <= 0) {
+            break;
+        }
+        len += (size_t)read_count;
     }
 
     pclose(pipe);
@@ -97,6 +185,247 @@ static inline cs_buffer cs_run_cmd_capture(const char *cmd) {
     return result;
 }
 
+typedef struct {
+    cs_buffer out;
+    cs_buffer err;
+    int status;
+} cs_cmd_result;
+
+typedef struct {
+    pid_t pid;
+    size_t index;
+    int fds[2];
+    size_t caps[2];
+} cs_cmd_job;
+
+static inline void cs_cmd_result_free(cs_cmd_result *result) {
+    free(result->out.data);
+    free(result->err.data);
+    memset(result, 0, sizeof(*result));
+}
+
+static inline int cs_cmd_pipe(int fds[2]) {
+#if defined(__linux__)
+    if (syscall(SYS_pipe2, fds, O_CLOEXEC) != 0) {
+        return errno ? -errno : -1;
+    }
+#else
+    if (pipe(fds) != 0) {
+        return errno ? -errno : -1;
+    }
+    if (fcntl(fds[0], F_SETFD, FD_CLOEXEC) != 0 ||
+        fcntl(fds[1], F_SETFD, FD_CLOEXEC) != 0) {
+        int rc = errno ? -errno : -1;
+        close(fds[0]);
+        close(fds[1]);
+        return rc;
+    }
+#endif
+    return 0;
+}
+
+static inline int cs_cmd_spawn(char *const argv[], cs_cmd_job *job) {
+    int out[2];
+    int err[2];
+    int rc = cs_cmd_pipe(out);
+    if (rc != 0) {
+        return rc;
+    }
+    rc = cs_cmd_pipe(err);
+    if (rc != 0) {
+        close(out[0]);
+        close(out[1]);
+        return rc;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, out[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, err[1], STDERR_FILENO);
+    int spawn_rc =
+        posix_spawnp(&job->pid, argv[0], &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(out[1]);
+    close(err[1]);
+    if (spawn_rc != 0) {
+        close(out[0]);
+        close(err[0]);
+        return -spawn_rc;
+    }
+
+    job->fds[0] = out[0];
+    job->fds[1] = err[0];
+    job->caps[0] = 0;
+    job->caps[1] = 0;
+    return 0;
+}
+
+static inline int cs_cmd_drain(cs_cmd_job *job, int stream,
+                               cs_buffer *buffer) {
+    size_t *cap = &job->caps[stream];
+    if (*cap - buffer->len < CS_CAPTURE_CHUNK) {
+        size_t next_cap = *cap ? *cap * 2 : CS_CAPTURE_CHUNK;
+        char *next = (char *)realloc(buffer->data, next_cap);
+        if (!next) {
+            return -ENOMEM;
+        }
+        buffer->data = next;
+        *cap = next_cap;
+    }
+    ssize_t n = read(job->fds[stream], buffer->data + buffer->len,
+                     *cap - buffer->len - 1);
+    if (n < 0) {
+        return errno == EINTR || errno == EAGAIN ? 0 : -errno;
+    }
+    if (n == 0) {
+        close(job->fds[stream]);
+        job->fds[stream] = -1;
+        return 0;
+    }
+    buffer->len += (size_t)n;
+    return 0;
+}
+
+static inline int cs_cmd_finish(cs_buffer *buffer) {
+    char *next = (char *)realloc(buffer->data, buffer->len + 1);
+    if (!next) {
+        return -ENOMEM;
+    }
+    next[buffer->len] = '\0';
+    buffer->data = next;
+    return 0;
+}
+
+static inline int cs_run_many(char **const *argvs, size_t count,
+                              size_t max_jobs, cs_cmd_result *results) {
+    if (max_jobs == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        max_jobs = cpus > 0 ? (size_t)cpus : 1;
+    }
+    if (max_jobs > count) {
+        max_jobs = count ? count : 1;
+    }
+    memset(results, 0, count * sizeof(*results));
+
+    cs_cmd_job *jobs = (cs_cmd_job *)calloc(max_jobs, sizeof(cs_cmd_job));
+    struct pollfd *polls =
+        (struct pollfd *)calloc(max_jobs * 2, sizeof(struct pollfd));
+    cs_cmd_job **owners = (cs_cmd_job **)calloc(max_jobs * 2, sizeof(void *));
+    if (!jobs || !polls || !owners) {
+        free(jobs);
+        free(polls);
+        free(owners);
+        return -ENOMEM;
+    }
+    for (size_t i = 0; i < max_jobs; i++) {
+        jobs[i].pid = -1;
+    }
+
+    int rc = 0;
+    size_t next = 0;
+    size_t running = 0;
+    while (next < count || running > 0) {
+        for (size_t i = 0; i < max_jobs && next < count && rc == 0; i++) {
+            if (jobs[i].pid != -1) {
+                continue;
+            }
+            int spawn_rc = cs_cmd_spawn(argvs[next], &jobs[i]);
+            if (spawn_rc != 0) {
+                results[next].status = spawn_rc;
+                jobs[i].pid = -1;
+            } else {
+                jobs[i].index = next;
+                running++;
+            }
+            next++;
+        }
+        if (rc != 0) {
+            next = count;
+        }
+        if (running == 0) {
+            continue;
+        }
+
+        nfds_t npoll = 0;
+        for (size_t i = 0; i < max_jobs; i++) {
+            for (int s = 0; s < 2; s++) {
+                if (jobs[i].pid != -1 && jobs[i].fds[s] >= 0) {
+                    polls[npoll].fd = jobs[i].fds[s];
+                    polls[npoll].events = POLLIN;
+                    polls[npoll].revents = 0;
+                    owners[npoll] = &jobs[i];
+                    npoll++;
+                }
+            }
+        }
+        if (npoll > 0 && poll(polls, npoll, -1) < 0 && errno != EINTR) {
+            rc = errno ? -errno : -1;
+        }
+
+        for (nfds_t p = 0; p < npoll; p++) {
+            if (!polls[p].revents) {
+                continue;
+            }
+            cs_cmd_job *job = owners[p];
+            cs_cmd_result *result = &results[job->index];
+            int stream = polls[p].fd == job->fds[0] ? 0 : 1;
+            int drain_rc = cs_cmd_drain(
+                job, stream, stream == 0 ? &result->out : &result->err);
+            if (drain_rc != 0 && rc == 0) {
+                rc = drain_rc;
+            }
+        }
+
+        for (size_t i = 0; i < max_jobs; i++) {
+            cs_cmd_job *job = &jobs[i];
+            if (job->pid == -1) {
+                continue;
+            }
+            if (rc != 0) {
+                for (int s = 0; s < 2; s++) {
+                    if (job->fds[s] >= 0) {
+                        close(job->fds[s]);
+                        job->fds[s] = -1;
+                    }
+                }
+            }
+            if (job->fds[0] >= 0 || job->fds[1] >= 0) {
+                continue;
+            }
+            cs_cmd_result *result = &results[job->index];
+            int status = 0;
+            while (waitpid(job->pid, &status, 0) < 0 && errno == EINTR) {
+            }
+            if (WIFEXITED(status)) {
+                result->status = WEXITSTATUS(status);
+            } else if (WIFSIGNALED(status)) {
+                result->status = 128 + WTERMSIG(status);
+            }
+            if ((cs_cmd_finish(&result->out) != 0 ||
+                 cs_cmd_finish(&result->err) != 0) &&
+                rc == 0) {
+                rc = -ENOMEM;
+            }
+            job->pid = -1;
+            running--;
+        }
+    }
+
+    free(jobs);
+    free(polls);
+    free(owners);
+    return rc;
+}
+
+static inline int cs_run_capture(char *const argv[], cs_cmd_result *result) {
+    char **argvs[1] = {(char **)argv};
+    int rc = cs_run_many(argvs, 1, 1, result);
+    if (rc == 0 && result->status < 0) {
+        rc = result->status;
+    }
+    return rc;
+}
+
 static inline int cs_list_dir(const char *path, char ***entries,
                               size_t *count) {
     DIR *dir = opendir(path);
@@ -148,4 +477,3881 @@ static inline int cs_list_dir(const char *path, char ***entries,
     return 0;
 }
 
+#ifndef CS_READER_BUFFER_SIZE
+#define CS_READER_BUFFER_SIZE (256 * 1024)
+#endif
+
+typedef struct {
+    int fd;
+    int owns_fd;
+    int delim;
+    int eof;
+    char *buf;
+    size_t cap;
+    size_t start;
+    size_t scan;
+    size_t end;
+} cs_reader;
+
+static inline int cs_reader_fd(cs_reader *reader, int fd, int delim) {
+    memset(reader, 0, sizeof(*reader));
+    reader->fd = fd;
+    reader->delim = delim;
+    reader->cap = CS_READER_BUFFER_SIZE;
+    reader->buf = (char *)malloc(reader->cap);
+    if (!reader->buf) {
+        reader->fd = -1;
+        return -ENOMEM;
+    }
+    return 0;
+}
+
+static inline int cs_records_open(cs_reader *reader, const char *path,
+                                  int delim) {
+    if (!path || strcmp(path, "-") == 0) {
+        return cs_reader_fd(reader, STDIN_FILENO, delim);
+    }
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        memset(reader, 0, sizeof(*reader));
+        reader->fd = -1;
+        return errno ? -errno : -1;
+    }
+    int rc = cs_reader_fd(reader, fd, delim);
+    if (rc != 0) {
+        close(fd);
+        return rc;
+    }
+    reader->owns_fd = 1;
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    return 0;
+}
+
+static inline int cs_lines_open(cs_reader *reader, const char *path) {
+    return cs_records_open(reader, path, '\n');
+}
+
+static inline int cs_reader_next(cs_reader *reader, cs_view *record) {
+    record->data = NULL;
+    record->len = 0;
+    for (;;) {
+        if (reader->scan < reader->end) {
+            char *hit = (char *)memchr(reader->buf + reader->scan,
+                                       reader->delim,
+                                       reader->end - reader->scan);
+            if (hit) {
+                size_t pos = (size_t)(hit - reader->buf);
+                record->data = reader->buf + reader->start;
+                record->len = pos - reader->start;
+                reader->start = pos + 1;
+                reader->scan = pos + 1;
+                return 1;
+            }
+            reader->scan = reader->end;
+        }
+
+        if (reader->eof) {
+            if (reader->start < reader->end) {
+                record->data = reader->buf + reader->start;
+                record->len = reader->end - reader->start;
+                reader->start = reader->end;
+                reader->scan = reader->end;
+                return 1;
+            }
+            return 0;
+        }
+
+        if (reader->start > 0) {
+            size_t pending = reader->end - reader->start;
+            memmove(reader->buf, reader->buf + reader->start, pending);
+            reader->scan -= reader->start;
+            reader->end = pending;
+            reader->start = 0;
+        }
+        if (reader->end == reader->cap) {
+            char *next = (char *)realloc(reader->buf, reader->cap * 2);
+            if (!next) {
+                return -ENOMEM;
+            }
+            reader->buf = next;
+            reader->cap *= 2;
+        }
+
+        ssize_t n = read(reader->fd, reader->buf + reader->end,
+                         reader->cap - reader->end);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno ? -errno : -1;
+        }
+        if (n == 0) {
+            reader->eof = 1;
+        }
+        reader->end += (size_t)n;
+    }
+}
+
+static inline void cs_reader_close(cs_reader *reader) {
+    if (reader->owns_fd && reader->fd >= 0) {
+        close(reader->fd);
+    }
+    free(reader->buf);
+    memset(reader, 0, sizeof(*reader));
+    reader->fd = -1;
+}
+
+#define CS_MAP_RANDOM 1
+
+typedef struct {
+    const char *data;
+    size_t len;
+    void *base;
+    size_t base_len;
+    int mapped;
+} cs_file_view;
+
+static inline int cs_map_stream(int fd, cs_file_view *view) {
+    size_t cap = CS_READER_BUFFER_SIZE;
+    size_t len = 0;
+    char *data = (char *)malloc(cap);
+    if (!data) {
+        return -ENOMEM;
+    }
+    for (;;) {
+        if (len == cap) {
+            char *next = (char *)realloc(data, cap * 2);
+            if (!next) {
+                free(data);
+                return -ENOMEM;
+            }
+            data = next;
+            cap *= 2;
+        }
+        ssize_t n = read(fd, data + len, cap - len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            int err = errno ? -errno : -1;
+            free(data);
+            return err;
+        }
+        if (n == 0) {
+            break;
+        }
+        len += (size_t)n;
+    }
+    view->base = data;
+    view->base_len = cap;
+    view->data = data;
+    view->len = len;
+    view->mapped = 0;
+    return 0;
+}
+
+static inline int cs_map_file(const char *path, cs_file_view *view,
+                              int flags) {
+    memset(view, 0, sizeof(*view));
+    view->data = "";
+    int fd = STDIN_FILENO;
+    if (path && strcmp(path, "-") != 0) {
+        fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return errno ? -errno : -1;
+        }
+    }
+
+    struct stat st;
+    int rc = 0;
+    if (fstat(fd, &st) != 0) {
+        rc = errno ? -errno : -1;
+    } else if (!S_ISREG(st.st_mode) || st.st_size == 0) {
+        rc = cs_map_stream(fd, view);
+    } else {
+        size_t size = (size_t)st.st_size;
+        void *base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (base == MAP_FAILED) {
+            rc = cs_map_stream(fd, view);
+        } else {
+            if (flags & CS_MAP_RANDOM) {
+                madvise(base, size, MADV_RANDOM);
+            } else {
+                madvise(base, size, MADV_SEQUENTIAL);
+                madvise(base, size, MADV_WILLNEED);
+            }
+            view->base = base;
+            view->base_len = size;
+            view->data = (const char *)base;
+            view->len = size;
+            view->mapped = 1;
+        }
+    }
+
+    if (fd != STDIN_FILENO) {
+        close(fd);
+    }
+    return rc;
+}
+
+static inline void cs_unmap_file(cs_file_view *view) {
+    if (view->mapped) {
+        munmap(view->base, view->base_len);
+    } else {
+        free(view->base);
+    }
+    memset(view, 0, sizeof(*view));
+}
+
+#ifndef CS_ARENA_BLOCK_SIZE
+#define CS_ARENA_BLOCK_SIZE (64 * 1024)
+#endif
+
+typedef struct cs_arena_block {
+    struct cs_arena_block *next;
+    size_t cap;
+    size_t used;
+    char data[];
+} cs_arena_block;
+
+typedef struct {
+    cs_arena_block *first;
+    cs_arena_block *current;
+    size_t block_size;
+} cs_arena;
+
+typedef struct {
+    cs_arena_block *block;
+    size_t used;
+} cs_arena_mark;
+
+static inline void cs_arena_init(cs_arena *arena, size_t block_size) {
+    arena->first = NULL;
+    arena->current = NULL;
+    arena->block_size = block_size ? block_size : CS_ARENA_BLOCK_SIZE;
+}
+
+static inline void *cs_arena_alloc_aligned(cs_arena *arena, size_t size,
+                                           size_t align) {
+    cs_arena_block *block = arena->current ? arena->current : arena->first;
+    while (block) {
+        uintptr_t base = (uintptr_t)block->data;
+        uintptr_t ptr =
+            (base + block->used + align - 1) & ~(uintptr_t)(align - 1);
+        if (ptr + size <= base + block->cap) {
+            block->used = (size_t)(ptr + size - base);
+            arena->current = block;
+            return (void *)ptr;
+        }
+        if (!block->next) {
+            break;
+        }
+        block = block->next;
+        block->used = 0;
+    }
+
+    size_t cap = arena->block_size ? arena->block_size : CS_ARENA_BLOCK_SIZE;
+    if (cap < size + align) {
+        cap = size + align;
+    }
+    cs_arena_block *fresh =
+        (cs_arena_block *)malloc(sizeof(cs_arena_block) + cap);
+    if (!fresh) {
+        return NULL;
+    }
+    fresh->next = NULL;
+    fresh->cap = cap;
+    fresh->used = 0;
+    if (block) {
+        block->next = fresh;
+    } else {
+        arena->first = fresh;
+    }
+    arena->current = fresh;
+    return cs_arena_alloc_aligned(arena, size, align);
+}
+
+static inline void *cs_arena_alloc(cs_arena *arena, size_t size) {
+    return cs_arena_alloc_aligned(arena, size, _Alignof(max_align_t));
+}
+
+static inline void *cs_arena_grow(cs_arena *arena, void *ptr, size_t old_size,
+                                  size_t new_size) {
+    cs_arena_block *block = arena->current;
+    if (ptr && block && (char *)ptr + old_size == block->data + block->used &&
+        (size_t)((char *)ptr - block->data) + new_size <= block->cap) {
+        block->used = (size_t)((char *)ptr - block->data) + new_size;
+        return ptr;
+    }
+    void *next = cs_arena_alloc(arena, new_size);
+    if (next && ptr) {
+        memcpy(next, ptr, old_size < new_size ? old_size : new_size);
+    }
+    return next;
+}
+
+static inline char *cs_arena_strndup(cs_arena *arena, const char *text,
+                                     size_t len) {
+    char *copy = (char *)cs_arena_alloc_aligned(arena, len + 1, 1);
+    if (!copy) {
+        return NULL;
+    }
+    memcpy(copy, text, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+static inline char *cs_arena_strdup(cs_arena *arena, const char *text) {
+    return cs_arena_strndup(arena, text, strlen(text));
+}
+
+static inline cs_arena_mark cs_arena_get_mark(const cs_arena *arena) {
+    cs_arena_mark mark = {arena->current, 0};
+    if (arena->current) {
+        mark.used = arena->current->used;
+    }
+    return mark;
+}
+
+static inline void cs_arena_reset_to(cs_arena *arena, cs_arena_mark mark) {
+    arena->current = mark.block ? mark.block : arena->first;
+    if (arena->current) {
+        arena->current->used = mark.block ? mark.used : 0;
+    }
+}
+
+static inline void cs_arena_reset(cs_arena *arena) {
+    cs_arena_mark mark = {NULL, 0};
+    cs_arena_reset_to(arena, mark);
+}
+
+static inline void cs_arena_free(cs_arena *arena) {
+    cs_arena_block *block = arena->first;
+    while (block) {
+        cs_arena_block *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->first = NULL;
+    arena->current = NULL;
+}
+
+static inline cs_buffer cs_arena_read_fd(cs_arena *arena, int fd,
+                                         size_t size_hint) {
+    cs_buffer result = {0};
+    size_t cap = size_hint ? size_hint + 1 : CS_READER_BUFFER_SIZE;
+    char *data = (char *)cs_arena_alloc_aligned(arena, cap, 1);
+    if (!data) {
+        return result;
+    }
+
+    size_t len = 0;
+    for (;;) {
+        if (len + 1 >= cap) {
+            char probe[256];
+            ssize_t n = read(fd, probe, sizeof(probe));
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return result;
+            }
+            if (n == 0) {
+                break;
+            }
+            char *next = (char *)cs_arena_grow(arena, data, cap,
+                                               cap * 2 + (size_t)n);
+            if (!next) {
+                return result;
+            }
+            data = next;
+            cap = cap * 2 + (size_t)n;
+            memcpy(data + len, probe, (size_t)n);
+            len += (size_t)n;
+            continue;
+        }
+        ssize_t n = read(fd, data + len, cap - len - 1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return result;
+        }
+        if (n == 0) {
+            break;
+        }
+        len += (size_t)n;
+    }
+
+    data[len] = '\0';
+    result.data = data;
+    result.len = len;
+    return result;
+}
+
+static inline cs_buffer cs_read_file_arena(cs_arena *arena, const char *path) {
+    cs_buffer result = {0};
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return result;
+    }
+    struct stat st;
+    size_t hint = 0;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        hint = (size_t)st.st_size;
+    }
+    cs_arena_mark mark = cs_arena_get_mark(arena);
+    result = cs_arena_read_fd(arena, fd, hint);
+    if (!result.data) {
+        cs_arena_reset_to(arena, mark);
+    }
+    close(fd);
+    return result;
+}
+
+static inline cs_buffer cs_run_cmd_capture_arena(cs_arena *arena,
+                                                 const char *cmd) {
+    cs_buffer result = {0};
+    FILE *pipe = popen(cmd, "r");
+    if (!pipe) {
+        return result;
+    }
+    cs_arena_mark mark = cs_arena_get_mark(arena);
+    result = cs_arena_read_fd(arena, fileno(pipe), 0);
+    if (!result.data) {
+        cs_arena_reset_to(arena, mark);
+    }
+    pclose(pipe);
+    return result;
+}
+
+static inline int cs_list_dir_arena(cs_arena *arena, const char *path,
+                                    char ***entries, size_t *count) {
+    DIR *dir = opendir(path);
+    if (!dir) {
+        return errno ? -errno : -1;
+    }
+
+    cs_arena_mark mark = cs_arena_get_mark(arena);
+    size_t cap = 64;
+    size_t len = 0;
+    char **list = (char **)cs_arena_alloc(arena, cap * sizeof(char *));
+    if (!list) {
+        closedir(dir);
+        return -1;
+    }
+
+    struct dirent *ent = NULL;
+    while ((ent = readdir(dir)) != NULL) {
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) {
+            continue;
+        }
+        if (len >= cap) {
+            char **next = (char **)cs_arena_grow(
+                arena, list, cap * sizeof(char *), cap * 2 * sizeof(char *));
+            if (!next) {
+                cs_arena_reset_to(arena, mark);
+                closedir(dir);
+                return -1;
+            }
+            list = next;
+            cap *= 2;
+        }
+        list[len] = cs_arena_strdup(arena, ent->d_name);
+        if (!list[len]) {
+            cs_arena_reset_to(arena, mark);
+            closedir(dir);
+            return -1;
+        }
+        len++;
+    }
+
+    closedir(dir);
+    *entries = list;
+    *count = len;
+    return 0;
+}
+
+#ifndef CS_GLOB_MAX_ALTERNATIVES
+#define CS_GLOB_MAX_ALTERNATIVES 256
+#endif
+
+#define CS_GLOB_LITERAL 1
+#define CS_GLOB_ANY 2
+#define CS_GLOB_STAR 3
+#define CS_GLOB_CLASS 4
+
+typedef struct {
+    int type;
+    size_t len;
+    const unsigned char *data;
+} cs_glob_op;
+
+typedef struct {
+    const cs_glob_op *ops;
+    size_t count;
+    size_t head;
+    size_t tail;
+    size_t min_len;
+    int globstar;
+} cs_glob_segment;
+
+typedef struct {
+    const cs_glob_segment *segments;
+    size_t count;
+} cs_glob_alt;
+
+typedef struct {
+    cs_glob_alt *alts;
+    size_t count;
+    cs_arena arena;
+} cs_glob;
+
+static inline size_t cs_glob_class_end(const char *pattern, size_t i,
+                                       size_t len) {
+    size_t j = i + 1;
+    if (j < len && (pattern[j] == '!' || pattern[j] == '^')) {
+        j++;
+    }
+    if (j < len && pattern[j] == ']') {
+        j++;
+    }
+    while (j < len && pattern[j] != ']') {
+        j += pattern[j] == '\\' && j + 1 < len ? 2 : 1;
+    }
+    return j < len ? j : 0;
+}
+
+static inline int cs_glob_compile_segment(cs_glob *glob, const char *text,
+                                          size_t len,
+                                          cs_glob_segment *segment) {
+    memset(segment, 0, sizeof(*segment));
+    if (len == 2 && text[0] == '*' && text[1] == '*') {
+        segment->globstar = 1;
+        return 0;
+    }
+
+    cs_glob_op *ops = (cs_glob_op *)cs_arena_alloc_aligned(
+        &glob->arena, (len ? len : 1) * sizeof(cs_glob_op),
+        _Alignof(cs_glob_op));
+    unsigned char *lit = (unsigned char *)cs_arena_alloc(&glob->arena,
+                                                         len ? len : 1);
+    if (!ops || !lit) {
+        return -ENOMEM;
+    }
+    size_t count = 0;
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)text[i];
+        if (c == '*') {
+            if (count == 0 || ops[count - 1].type != CS_GLOB_STAR) {
+                ops[count++] = (cs_glob_op){CS_GLOB_STAR, 0, NULL};
+            }
+            continue;
+        }
+        if (c == '?') {
+            ops[count++] = (cs_glob_op){CS_GLOB_ANY, 1, NULL};
+            continue;
+        }
+        size_t end = c == '[' ? cs_glob_class_end(text, i, len) : 0;
+        if (end) {
+            unsigned char *bits =
+                (unsigned char *)cs_arena_alloc(&glob->arena, 32);
+            if (!bits) {
+                return -ENOMEM;
+            }
+            memset(bits, 0, 32);
+            size_t j = i + 1;
+            int negate = text[j] == '!' || text[j] == '^';
+            j += negate;
+            while (j < end) {
+                unsigned char lo = (unsigned char)text[j];
+                if (lo == '\\' && j + 1 < end) {
+                    lo = (unsigned char)text[++j];
+                }
+                j++;
+                unsigned char hi = lo;
+                if (j + 1 < end && text[j] == '-') {
+                    hi = (unsigned char)text[j + 1];
+                    if (hi == '\\' && j + 2 < end) {
+                        hi = (unsigned char)text[j + 2];
+                        j++;
+                    }
+                    j += 2;
+                }
+                for (unsigned v = lo; v <= hi; v++) {
+                    bits[v >> 3] |= (unsigned char)(1u << (v & 7));
+                }
+            }
+            if (negate) {
+                for (int b = 0; b < 32; b++) {
+                    bits[b] = (unsigned char)~bits[b];
+                }
+            }
+            bits['/' >> 3] &= (unsigned char)~(1u << ('/' & 7));
+            ops[count++] = (cs_glob_op){CS_GLOB_CLASS, 1, bits};
+            i = end;
+            continue;
+        }
+        if (c == '\\' && i + 1 < len) {
+            c = (unsigned char)text[++i];
+        }
+        if (count > 0 && ops[count - 1].type == CS_GLOB_LITERAL &&
+            ops[count - 1].data + ops[count - 1].len == lit) {
+            ops[count - 1].len++;
+        } else {
+            ops[count++] = (cs_glob_op){CS_GLOB_LITERAL, 1, lit};
+        }
+        *lit++ = c;
+    }
+
+    segment->ops = ops;
+    segment->count = count;
+    segment->head = count;
+    segment->tail = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (ops[i].type == CS_GLOB_STAR) {
+            if (segment->head == count) {
+                segment->head = i;
+            }
+            segment->tail = i + 1;
+        }
+        segment->min_len += ops[i].len;
+    }
+    return 0;
+}
+
+static inline int cs_glob_add(cs_glob *glob, const char *pattern,
+                              size_t len) {
+    if (glob->count == CS_GLOB_MAX_ALTERNATIVES) {
+        return -E2BIG;
+    }
+    if (glob->count == 0 || (glob->count & (glob->count - 1)) == 0) {
+        size_t cap = glob->count ? glob->count * 2 : 1;
+        cs_glob_alt *alts =
+            (cs_glob_alt *)realloc(glob->alts, cap * sizeof(cs_glob_alt));
+        if (!alts) {
+            return -ENOMEM;
+        }
+        glob->alts = alts;
+    }
+
+    size_t segments = 1;
+    for (size_t i = 0; i < len; i++) {
+        segments += pattern[i] == '/';
+    }
+    cs_glob_segment *segs = (cs_glob_segment *)cs_arena_alloc_aligned(
+        &glob->arena, segments * sizeof(cs_glob_segment),
+        _Alignof(cs_glob_segment));
+    if (!segs) {
+        return -ENOMEM;
+    }
+    size_t count = 0;
+    size_t start = 0;
+    for (size_t i = 0; i <= len; i++) {
+        if (i < len && pattern[i] == '[') {
+            size_t end = cs_glob_class_end(pattern, i, len);
+            if (end && !memchr(pattern + i, '/', end - i)) {
+                i = end;
+                continue;
+            }
+        }
+        if (i + 1 < len && pattern[i] == '\\') {
+            i++;
+            continue;
+        }
+        if (i < len && pattern[i] != '/') {
+            continue;
+        }
+        int rc = cs_glob_compile_segment(glob, pattern + start, i - start,
+                                         &segs[count]);
+        if (rc != 0) {
+            return rc;
+        }
+        if (!segs[count].globstar || count == 0 ||
+            !segs[count - 1].globstar) {
+            count++;
+        }
+        start = i + 1;
+    }
+    glob->alts[glob->count].segments = segs;
+    glob->alts[glob->count].count = count;
+    glob->count++;
+    return 0;
+}
+
+static inline int cs_glob_expand(cs_glob *glob, const char *pattern,
+                                 size_t len) {
+    size_t open = len;
+    size_t close = len;
+    int depth = 0;
+    int comma = 0;
+    for (size_t i = 0; i < len && close == len; i++) {
+        char c = pattern[i];
+        if (c == '\\') {
+            i++;
+        } else if (c == '[') {
+            size_t end = cs_glob_class_end(pattern, i, len);
+            i = end ? end : i;
+        } else if (c == '{') {
+            if (depth++ == 0) {
+                open = i;
+                comma = 0;
+            }
+        } else if (c == ',' && depth == 1) {
+            comma = 1;
+        } else if (c == '}' && depth > 0 && --depth == 0 && comma) {
+            close = i;
+        }
+    }
+    if (close == len) {
+        return cs_glob_add(glob, pattern, len);
+    }
+
+    char *buf = (char *)malloc(len);
+    if (!buf) {
+        return -ENOMEM;
+    }
+    memcpy(buf, pattern, open);
+    size_t suffix = len - close - 1;
+    size_t start = open + 1;
+    depth = 0;
+    int rc = 0;
+    for (size_t i = open + 1; i <= close && rc == 0; i++) {
+        char c = pattern[i];
+        if (i < close && c == '\\') {
+            i++;
+            continue;
+        }
+        if (i < close && c == '[') {
+            size_t end = cs_glob_class_end(pattern, i, close);
+            i = end ? end : i;
+            continue;
+        }
+        if (i < close && c == '{') {
+            depth++;
+            continue;
+        }
+        if (i < close && c == '}') {
+            depth--;
+            continue;
+        }
+        if (i < close && (c != ',' || depth > 0)) {
+            continue;
+        }
+        size_t alt = i - start;
+        memcpy(buf + open, pattern + start, alt);
+        memcpy(buf + open + alt, pattern + close + 1, suffix);
+        rc = cs_glob_expand(glob, buf, open + alt + suffix);
+        start = i + 1;
+    }
+    free(buf);
+    return rc;
+}
+
+static inline void cs_glob_free(cs_glob *glob) {
+    free(glob->alts);
+    cs_arena_free(&glob->arena);
+    memset(glob, 0, sizeof(*glob));
+}
+
+static inline int cs_glob_compile(cs_glob *glob, const char *pattern) {
+    memset(glob, 0, sizeof(*glob));
+    cs_arena_init(&glob->arena, 4096);
+    int rc = cs_glob_expand(glob, pattern, strlen(pattern));
+    if (rc != 0) {
+        cs_glob_free(glob);
+    }
+    return rc;
+}
+
+static inline int cs_glob_piece(const cs_glob_op *ops, size_t begin,
+                                size_t end, const unsigned char *s) {
+    for (size_t i = begin; i < end; i++) {
+        const cs_glob_op *op = &ops[i];
+        if (op->type == CS_GLOB_LITERAL) {
+            if (memcmp(s, op->data, op->len) != 0) {
+                return 0;
+            }
+        } else if (op->type == CS_GLOB_CLASS &&
+                   !(op->data[*s >> 3] & (1u << (*s & 7)))) {
+            return 0;
+        }
+        s += op->len;
+    }
+    return 1;
+}
+
+static inline int cs_glob_segment_match(const cs_glob_segment *segment,
+                                        const unsigned char *s, size_t n) {
+    const cs_glob_op *ops = segment->ops;
+    if (n < segment->min_len) {
+        return 0;
+    }
+    if (segment->head == segment->count) {
+        return n == segment->min_len &&
+               cs_glob_piece(ops, 0, segment->count, s);
+    }
+
+    size_t pos = 0;
+    for (size_t i = 0; i < segment->head; i++) {
+        pos += ops[i].len;
+    }
+    size_t limit = n;
+    for (size_t i = segment->tail; i < segment->count; i++) {
+        limit -= ops[i].len;
+    }
+    if (!cs_glob_piece(ops, 0, segment->head, s) ||
+        !cs_glob_piece(ops, segment->tail, segment->count, s + limit)) {
+        return 0;
+    }
+
+    size_t i = segment->head + 1;
+    while (i < segment->tail) {
+        size_t j = i;
+        size_t width = 0;
+        while (ops[j].type != CS_GLOB_STAR) {
+            width += ops[j++].len;
+        }
+        if (j == i + 1 && ops[i].type == CS_GLOB_LITERAL) {
+            const unsigned char *lit = ops[i].data;
+            for (;;) {
+                if (limit - pos < width) {
+                    return 0;
+                }
+                const unsigned char *hit = (const unsigned char *)memchr(
+                    s + pos, lit[0], limit - pos - width + 1);
+                if (!hit) {
+                    return 0;
+                }
+                pos = (size_t)(hit - s);
+                if (memcmp(hit + 1, lit + 1, width - 1) == 0) {
+                    break;
+                }
+                pos++;
+            }
+            pos += width;
+        } else {
+            for (;;) {
+                if (limit - pos < width) {
+                    return 0;
+                }
+                if (cs_glob_piece(ops, i, j, s + pos)) {
+                    break;
+                }
+                pos++;
+            }
+            pos += width;
+        }
+        if (pos > limit) {
+            return 0;
+        }
+        i = j + 1;
+    }
+    return 1;
+}
+
+static inline int cs_glob_alt_match(const cs_glob_alt *alt, const char *path,
+                                    size_t len, int prefix) {
+    const cs_glob_segment *segs = alt->segments;
+    size_t count = alt->count;
+    size_t pi = 0;
+    size_t si = len ? 0 : 1;
+    size_t star_p = count;
+    size_t star_s = 0;
+    for (;;) {
+        if (pi < count && segs[pi].globstar) {
+            star_p = pi++;
+            star_s = si;
+            continue;
+        }
+        if (si > len) {
+            return prefix ? pi < count || star_p < count : pi == count;
+        }
+        const char *end = (const char *)memchr(path + si, '/', len - si);
+        size_t seg_end = end ? (size_t)(end - path) : len;
+        if (pi < count &&
+            cs_glob_segment_match(&segs[pi],
+                                  (const unsigned char *)path + si,
+                                  seg_end - si)) {
+            pi++;
+            si = seg_end + 1;
+            continue;
+        }
+        if (star_p == count) {
+            return 0;
+        }
+        end = (const char *)memchr(path + star_s, '/', len - star_s);
+        star_s = end ? (size_t)(end - path) + 1 : len + 1;
+        si = star_s;
+        pi = star_p + 1;
+    }
+}
+
+static inline int cs_glob_match(const cs_glob *glob, const char *path,
+                                size_t len) {
+    for (size_t i = 0; i < glob->count; i++) {
+        if (cs_glob_alt_match(&glob->alts[i], path, len, 0)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static inline int cs_glob_match_dir(const cs_glob *glob, const char *path,
+                                    size_t len) {
+    for (size_t i = 0; i < glob->count; i++) {
+        if (cs_glob_alt_match(&glob->alts[i], path, len, 1)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+#define CS_WALK_FILE 1
+#define CS_WALK_DIR 2
+#define CS_WALK_LINK 3
+#define CS_WALK_OTHER 4
+
+#define CS_WALK_STAT 1
+
+#ifndef CS_WALK_BATCH
+#define CS_WALK_BATCH 256
+#endif
+
+typedef struct {
+    const char *path;
+    const char *name;
+    size_t path_len;
+    int type;
+    int depth;
+    long long size;
+} cs_walk_entry;
+
+typedef int (*cs_walk_fn)(const cs_walk_entry *entries, size_t count,
+                          void *ctx);
+
+typedef struct {
+    int threads;
+    int flags;
+    int max_depth;
+    size_t batch;
+} cs_walk_opts;
+
+typedef struct {
+    atomic_int refs;
+    int fd;
+} cs_walk_parent;
+
+typedef struct {
+    cs_walk_parent *parent;
+    int fd;
+    int depth;
+    size_t len;
+    size_t name_offset;
+    char path[];
+} cs_walk_item;
+
+typedef struct {
+    pthread_mutex_t lock;
+    cs_walk_item **items;
+    size_t head;
+    size_t tail;
+    size_t cap;
+} cs_walk_queue;
+
+typedef struct {
+    cs_walk_queue *queues;
+    int threads;
+    int flags;
+    int max_depth;
+    size_t batch;
+    const cs_glob *glob;
+    size_t rel_offset;
+    cs_walk_fn fn;
+    void *ctx;
+    atomic_size_t pending;
+    atomic_int stop;
+    atomic_int error;
+    pthread_mutex_t idle_lock;
+    pthread_cond_t idle_cond;
+} cs_walk_state;
+
+typedef struct {
+    cs_walk_state *state;
+    int id;
+    cs_walk_entry *entries;
+    size_t *path_offsets;
+    size_t *name_offsets;
+    size_t count;
+    char *text;
+    size_t text_len;
+    size_t text_cap;
+} cs_walk_worker;
+
+static inline int cs_walk_push(cs_walk_queue *queue, cs_walk_item *item) {
+    pthread_mutex_lock(&queue->lock);
+    if (queue->tail == queue->cap) {
+        if (queue->head > 0) {
+            memmove(queue->items, queue->items + queue->head,
+                    (queue->tail - queue->head) * sizeof(cs_walk_item *));
+            queue->tail -= queue->head;
+            queue->head = 0;
+        } else {
+            size_t cap = queue->cap ? queue->cap * 2 : 64;
+            cs_walk_item **next = (cs_walk_item **)realloc(
+                queue->items, cap * sizeof(cs_walk_item *));
+            if (!next) {
+                pthread_mutex_unlock(&queue->lock);
+                return -ENOMEM;
+            }
+            queue->items = next;
+            queue->cap = cap;
+        }
+    }
+    queue->items[queue->tail++] = item;
+    pthread_mutex_unlock(&queue->lock);
+    return 0;
+}
+
+static inline cs_walk_item *cs_walk_take(cs_walk_queue *queue, int steal) {
+    cs_walk_item *item = NULL;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->head < queue->tail) {
+        item = steal ? queue->items[queue->head++]
+                     : queue->items[--queue->tail];
+        if (queue->head == queue->tail) {
+            queue->head = 0;
+            queue->tail = 0;
+        }
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return item;
+}
+
+static inline int cs_walk_idle(cs_walk_state *state) {
+    for (int i = 0; i < state->threads; i++) {
+        cs_walk_queue *queue = &state->queues[i];
+        pthread_mutex_lock(&queue->lock);
+        int empty = queue->head == queue->tail;
+        pthread_mutex_unlock(&queue->lock);
+        if (!empty) {
+            return 0;
+        }
+    }
+    return atomic_load(&state->pending) != 0;
+}
+
+static inline void cs_walk_fail(cs_walk_state *state, int err) {
+    int expected = 0;
+    atomic_compare_exchange_strong(&state->error, &expected,
+                                   err ? err : -EIO);
+}
+
+static inline void cs_walk_unref(cs_walk_parent *parent) {
+    if (parent && atomic_fetch_sub(&parent->refs, 1) == 1) {
+        close(parent->fd);
+        free(parent);
+    }
+}
+
+static inline void cs_walk_release(cs_walk_item *item) {
+    if (item->fd >= 0) {
+        close(item->fd);
+    }
+    cs_walk_unref(item->parent);
+    free(item);
+}
+
+static inline void cs_walk_flush(cs_walk_worker *worker) {
+    cs_walk_state *state = worker->state;
+    if (worker->count == 0) {
+        return;
+    }
+    for (size_t i = 0; i < worker->count; i++) {
+        cs_walk_entry *entry = &worker->entries[i];
+        entry->path = worker->text + worker->path_offsets[i];
+        entry->name = entry->path + worker->name_offsets[i];
+    }
+    if (!atomic_load(&state->stop)) {
+        int rc = state->fn(worker->entries, worker->count, state->ctx);
+        if (rc != 0) {
+            int expected = 0;
+            atomic_compare_exchange_strong(&state->stop, &expected, rc);
+        }
+    }
+    worker->count = 0;
+    worker->text_len = 0;
+}
+
+static inline int cs_walk_emit(cs_walk_worker *worker, const char *dir,
+                               size_t dir_len, const char *name, int type,
+                               int depth, long long size) {
+    size_t name_len = strlen(name);
+    size_t sep = dir_len > 0 && dir[dir_len - 1] != '/' ? 1 : 0;
+    size_t path_len = dir_len + sep + name_len;
+    if (worker->text_len + path_len + 1 > worker->text_cap) {
+        size_t cap = worker->text_cap ? worker->text_cap : 4096;
+        while (worker->text_len + path_len + 1 > cap) {
+            cap *= 2;
+        }
+        char *next = (char *)realloc(worker->text, cap);
+        if (!next) {
+            return -ENOMEM;
+        }
+        worker->text = next;
+        worker->text_cap = cap;
+    }
+
+    char *path = worker->text + worker->text_len;
+    memcpy(path, dir, dir_len);
+    if (sep) {
+        path[dir_len] = '/';
+    }
+    memcpy(path + dir_len + sep, name, name_len + 1);
+    const cs_glob *glob = worker->state->glob;
+    size_t rel = worker->state->rel_offset;
+    if (glob && !cs_glob_match(glob, path + rel, path_len - rel)) {
+        return 0;
+    }
+
+    cs_walk_entry *entry = &worker->entries[worker->count];
+    worker->path_offsets[worker->count] = worker->text_len;
+    worker->name_offsets[worker->count] = dir_len + sep;
+    entry->path = NULL;
+    entry->name = NULL;
+    entry->path_len = path_len;
+    entry->type = type;
+    entry->depth = depth;
+    entry->size = size;
+    worker->text_len += path_len + 1;
+    worker->count++;
+
+    if (worker->count == worker->state->batch) {
+        cs_walk_flush(worker);
+    }
+    return 0;
+}
+
+static inline void cs_walk_dir(cs_walk_worker *worker, cs_walk_item *item) {
+    cs_walk_state *state = worker->state;
+    int fd = item->fd;
+    if (fd < 0) {
+        fd = openat(item->parent->fd, item->path + item->name_offset,
+                    O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            cs_walk_fail(state, -errno);
+            return;
+        }
+    }
+    item->fd = -1;
+    DIR *dir = fdopendir(fd);
+    if (!dir) {
+        cs_walk_fail(state, -errno);
+        close(fd);
+        return;
+    }
+
+    int depth = item->depth + 1;
+    int descend = state->max_depth <= 0 || depth < state->max_depth;
+    cs_walk_parent *shared = NULL;
+    struct dirent *ent = NULL;
+    for (;;) {
+        if (atomic_load(&state->stop)) {
+            break;
+        }
+        errno = 0;
+        if ((ent = readdir(dir)) == NULL) {
+            if (errno != 0) {
+                cs_walk_fail(state, -errno);
+            }
+            break;
+        }
+        const char *name = ent->d_name;
+        if (name[0] == '.' &&
+            (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+            continue;
+        }
+
+        int type = CS_WALK_OTHER;
+        long long size = -1;
+        unsigned char d_type = ent->d_type;
+        if (d_type == DT_UNKNOWN || (state->flags & CS_WALK_STAT)) {
+            struct stat st;
+            if (fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) == 0) {
+                d_type = S_ISREG(st.st_mode)   ? DT_REG
+                         : S_ISDIR(st.st_mode) ? DT_DIR
+                         : S_ISLNK(st.st_mode) ? DT_LNK
+                                               : DT_UNKNOWN;
+                size = (long long)st.st_size;
+            }
+        }
+        if (d_type == DT_REG) {
+            type = CS_WALK_FILE;
+        } else if (d_type == DT_DIR) {
+            type = CS_WALK_DIR;
+        } else if (d_type == DT_LNK) {
+            type = CS_WALK_LINK;
+        }
+
+        int rc = cs_walk_emit(worker, item->path, item->len, name, type,
+                              depth, size);
+        if (rc != 0) {
+            cs_walk_fail(state, rc);
+            continue;
+        }
+        if (type != CS_WALK_DIR || !descend) {
+            continue;
+        }
+        if (!shared) {
+            shared = (cs_walk_parent *)malloc(sizeof(cs_walk_parent));
+            int copy = shared ? fcntl(fd, F_DUPFD_CLOEXEC, 0) : -1;
+            if (copy < 0) {
+                cs_walk_fail(state, shared ? -errno : -ENOMEM);
+                free(shared);
+                shared = NULL;
+                continue;
+            }
+            atomic_init(&shared->refs, 1);
+            shared->fd = copy;
+        }
+
+        size_t name_len = strlen(name);
+        size_t sep = item->path[item->len - 1] != '/' ? 1 : 0;
+        size_t len = item->len + sep + name_len;
+        cs_walk_item *child =
+            (cs_walk_item *)malloc(sizeof(cs_walk_item) + len + 1);
+        if (!child) {
+            cs_walk_fail(state, -ENOMEM);
+            continue;
+        }
+        child->parent = shared;
+        child->fd = -1;
+        child->depth = depth;
+        child->len = len;
+        child->name_offset = item->len + sep;
+        memcpy(child->path, item->path, item->len);
+        if (sep) {
+            child->path[item->len] = '/';
+        }
+        memcpy(child->path + item->len + sep, name, name_len + 1);
+        if (state->glob &&
+            !cs_glob_match_dir(state->glob, child->path + state->rel_offset,
+                               len - state->rel_offset)) {
+            free(child);
+            continue;
+        }
+
+        atomic_fetch_add(&shared->refs, 1);
+        atomic_fetch_add(&state->pending, 1);
+        if (cs_walk_push(&state->queues[worker->id], child) != 0) {
+            atomic_fetch_sub(&state->pending, 1);
+            cs_walk_fail(state, -ENOMEM);
+            cs_walk_release(child);
+            continue;
+        }
+        pthread_mutex_lock(&state->idle_lock);
+        pthread_cond_signal(&state->idle_cond);
+        pthread_mutex_unlock(&state->idle_lock);
+    }
+    closedir(dir);
+    cs_walk_unref(shared);
+}
+
+static inline void *cs_walk_worker_main(void *arg) {
+    cs_walk_worker *worker = (cs_walk_worker *)arg;
+    cs_walk_state *state = worker->state;
+    for (;;) {
+        cs_walk_item *item = cs_walk_take(&state->queues[worker->id], 0);
+        for (int i = 1; !item && i < state->threads; i++) {
+            int victim = (worker->id + i) % state->threads;
+            item = cs_walk_take(&state->queues[victim], 1);
+        }
+
+        if (item) {
+            if (!atomic_load(&state->stop)) {
+                cs_walk_dir(worker, item);
+            }
+            cs_walk_release(item);
+            if (atomic_fetch_sub(&state->pending, 1) == 1) {
+                pthread_mutex_lock(&state->idle_lock);
+                pthread_cond_broadcast(&state->idle_cond);
+                pthread_mutex_unlock(&state->idle_lock);
+            }
+            continue;
+        }
+
+        if (atomic_load(&state->pending) == 0) {
+            break;
+        }
+        pthread_mutex_lock(&state->idle_lock);
+        while (cs_walk_idle(state)) {
+            pthread_cond_wait(&state->idle_cond, &state->idle_lock);
+        }
+        pthread_mutex_unlock(&state->idle_lock);
+    }
+    cs_walk_flush(worker);
+    return NULL;
+}
+
+static inline int cs_walk_glob(const char *root, const cs_walk_opts *opts,
+                               const cs_glob *glob, cs_walk_fn fn,
+                               void *ctx) {
+    cs_walk_opts defaults = {0, 0, 0, 0};
+    if (!opts) {
+        opts = &defaults;
+    }
+    int threads = opts->threads;
+    if (threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (int)cpus : 1;
+    }
+
+    int fd = openat(AT_FDCWD, root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return errno ? -errno : -1;
+    }
+    size_t root_len = strlen(root);
+    while (root_len > 1 && root[root_len - 1] == '/') {
+        root_len--;
+    }
+    cs_walk_item *item =
+        (cs_walk_item *)malloc(sizeof(cs_walk_item) + root_len + 1);
+    if (!item) {
+        close(fd);
+        return -ENOMEM;
+    }
+    item->parent = NULL;
+    item->fd = fd;
+    item->depth = 0;
+    item->len = root_len;
+    item->name_offset = 0;
+    memcpy(item->path, root, root_len);
+    item->path[root_len] = '\0';
+
+    cs_walk_state state;
+    memset(&state, 0, sizeof(state));
+    state.threads = threads;
+    state.flags = opts->flags;
+    state.max_depth = opts->max_depth;
+    state.batch = opts->batch ? opts->batch : CS_WALK_BATCH;
+    state.glob = glob;
+    state.rel_offset = root_len + (root[root_len - 1] != '/');
+    state.fn = fn;
+    state.ctx = ctx;
+    atomic_init(&state.pending, 1);
+    atomic_init(&state.stop, 0);
+    atomic_init(&state.error, 0);
+    pthread_mutex_init(&state.idle_lock, NULL);
+    pthread_cond_init(&state.idle_cond, NULL);
+
+    int rc = 0;
+    state.queues = (cs_walk_queue *)calloc((size_t)threads,
+                                           sizeof(cs_walk_queue));
+    cs_walk_worker *workers =
+        (cs_walk_worker *)calloc((size_t)threads, sizeof(cs_walk_worker));
+    pthread_t *tids = (pthread_t *)calloc((size_t)threads, sizeof(pthread_t));
+    if (!state.queues || !workers || !tids) {
+        rc = -ENOMEM;
+        threads = 0;
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_mutex_init(&state.queues[i].lock, NULL);
+        workers[i].state = &state;
+        workers[i].id = i;
+        workers[i].entries =
+            (cs_walk_entry *)malloc(state.batch * sizeof(cs_walk_entry));
+        workers[i].path_offsets =
+            (size_t *)malloc(state.batch * sizeof(size_t));
+        workers[i].name_offsets =
+            (size_t *)malloc(state.batch * sizeof(size_t));
+        if (!workers[i].entries || !workers[i].path_offsets ||
+            !workers[i].name_offsets) {
+            rc = -ENOMEM;
+        }
+    }
+
+    if (rc == 0 && cs_walk_push(&state.queues[0], item) == 0) {
+        item = NULL;
+        int started = 1;
+        for (int i = 1; i < threads; i++) {
+            if (pthread_create(&tids[i], NULL, cs_walk_worker_main,
+                               &workers[i]) != 0) {
+                break;
+            }
+            started++;
+        }
+        cs_walk_worker_main(&workers[0]);
+        for (int i = 1; i < started; i++) {
+            pthread_join(tids[i], NULL);
+        }
+        rc = atomic_load(&state.stop);
+        if (rc == 0) {
+            rc = atomic_load(&state.error);
+        }
+    } else if (rc == 0) {
+        rc = -ENOMEM;
+    }
+
+    if (item) {
+        cs_walk_release(item);
+    }
+    for (int i = 0; i < threads; i++) {
+        cs_walk_item *left = NULL;
+        while ((left = cs_walk_take(&state.queues[i], 1)) != NULL) {
+            cs_walk_release(left);
+        }
+        free(state.queues[i].items);
+        pthread_mutex_destroy(&state.queues[i].lock);
+        free(workers[i].entries);
+        free(workers[i].path_offsets);
+        free(workers[i].name_offsets);
+        free(workers[i].text);
+    }
+    free(state.queues);
+    free(workers);
+    free(tids);
+    pthread_mutex_destroy(&state.idle_lock);
+    pthread_cond_destroy(&state.idle_cond);
+    return rc;
+}
+
+static inline int cs_walk(const char *root, const cs_walk_opts *opts,
+                          cs_walk_fn fn, void *ctx) {
+    return cs_walk_glob(root, opts, NULL, fn, ctx);
+}
+
+#define CS_CACHE_LINE 64
+
+typedef void (*cs_range_fn)(size_t begin, size_t end, int worker, void *ctx);
+typedef void (*cs_entry_fn)(const char *entry, size_t index, int worker,
+                            void *ctx);
+
+typedef struct {
+    _Alignas(CS_CACHE_LINE) atomic_size_t next;
+    size_t end;
+} cs_pool_range;
+
+typedef struct {
+    _Alignas(CS_CACHE_LINE) void *data;
+    size_t cap;
+} cs_pool_scratch_buf;
+
+typedef struct cs_pool {
+    int threads;
+    pthread_t *tids;
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;
+    pthread_cond_t done_cond;
+    pthread_mutex_t run_lock;
+    unsigned long generation;
+    int shutdown;
+    int active;
+    cs_range_fn fn;
+    void *ctx;
+    size_t chunk;
+    cs_pool_range *ranges;
+    cs_pool_scratch_buf *scratch;
+} cs_pool;
+
+typedef struct {
+    cs_pool *pool;
+    int id;
+} cs_pool_thread_arg;
+
+static _Thread_local cs_pool *cs_pool_current;
+static _Thread_local int cs_pool_current_id;
+
+static inline void cs_pool_run(cs_pool *pool, int id) {
+    cs_pool *outer = cs_pool_current;
+    int outer_id = cs_pool_current_id;
+    cs_pool_current = pool;
+    cs_pool_current_id = id;
+    for (int i = 0; i < pool->threads; i++) {
+        cs_pool_range *range = &pool->ranges[(id + i) % pool->threads];
+        for (;;) {
+            size_t begin = atomic_fetch_add(&range->next, pool->chunk);
+            if (begin >= range->end) {
+                break;
+            }
+            size_t end = begin + pool->chunk;
+            if (end > range->end) {
+                end = range->end;
+            }
+            pool->fn(begin, end, id, pool->ctx);
+        }
+    }
+    cs_pool_current = outer;
+    cs_pool_current_id = outer_id;
+}
+
+static inline void *cs_pool_thread_main(void *arg) {
+    cs_pool_thread_arg *thread = (cs_pool_thread_arg *)arg;
+    cs_pool *pool = thread->pool;
+    int id = thread->id;
+    free(thread);
+
+    unsigned long seen = 0;
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->shutdown && pool->generation == seen) {
+            pthread_cond_wait(&pool->work_cond, &pool->lock);
+        }
+        if (pool->shutdown) {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        cs_pool_run(pool, id);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->active == 0) {
+            pthread_cond_signal(&pool->done_cond);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+    return NULL;
+}
+
+static inline void cs_pool_destroy(cs_pool *pool) {
+    if (!pool) {
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 1; i < pool->threads; i++) {
+        pthread_join(pool->tids[i], NULL);
+    }
+    for (int i = 0; i < pool->threads; i++) {
+        free(pool->scratch[i].data);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_cond_destroy(&pool->done_cond);
+    pthread_mutex_destroy(&pool->run_lock);
+    free(pool->tids);
+    free(pool->ranges);
+    free(pool->scratch);
+    free(pool);
+}
+
+static inline cs_pool *cs_pool_create(int threads) {
+    if (threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (int)cpus : 1;
+    }
+    cs_pool *pool = (cs_pool *)calloc(1, sizeof(cs_pool));
+    if (!pool) {
+        return NULL;
+    }
+    size_t ranges_size = (size_t)threads * sizeof(cs_pool_range);
+    size_t scratch_size = (size_t)threads * sizeof(cs_pool_scratch_buf);
+    pool->tids = (pthread_t *)calloc((size_t)threads, sizeof(pthread_t));
+    pool->ranges =
+        (cs_pool_range *)aligned_alloc(CS_CACHE_LINE, ranges_size);
+    pool->scratch =
+        (cs_pool_scratch_buf *)aligned_alloc(CS_CACHE_LINE, scratch_size);
+    if (!pool->tids || !pool->ranges || !pool->scratch) {
+        free(pool->tids);
+        free(pool->ranges);
+        free(pool->scratch);
+        free(pool);
+        return NULL;
+    }
+    memset(pool->scratch, 0, scratch_size);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+    pthread_mutex_init(&pool->run_lock, NULL);
+
+    pool->threads = 1;
+    for (int i = 1; i < threads; i++) {
+        cs_pool_thread_arg *arg =
+            (cs_pool_thread_arg *)malloc(sizeof(cs_pool_thread_arg));
+        if (!arg) {
+            break;
+        }
+        arg->pool = pool;
+        arg->id = i;
+        if (pthread_create(&pool->tids[i], NULL, cs_pool_thread_main, arg) !=
+            0) {
+            free(arg);
+            break;
+        }
+        pool->threads++;
+    }
+    return pool;
+}
+
+static inline int cs_pool_threads(const cs_pool *pool) {
+    return pool->threads;
+}
+
+static inline void *cs_pool_scratch(cs_pool *pool, int worker, size_t size) {
+    cs_pool_scratch_buf *buf = &pool->scratch[worker];
+    if (buf->cap < size) {
+        void *next = realloc(buf->data, size);
+        if (!next) {
+            return NULL;
+        }
+        buf->data = next;
+        buf->cap = size;
+    }
+    return buf->data;
+}
+
+static inline int cs_parallel_for(cs_pool *pool, size_t count, size_t chunk,
+                                  cs_range_fn fn, void *ctx) {
+    if (pool && pool == cs_pool_current) {
+        if (chunk == 0) {
+            chunk = count ? count : 1;
+        }
+        for (size_t begin = 0; begin < count; begin += chunk) {
+            size_t end = count - begin < chunk ? count : begin + chunk;
+            fn(begin, end, cs_pool_current_id, ctx);
+        }
+        return 0;
+    }
+
+    cs_pool *owned = NULL;
+    if (!pool) {
+        owned = cs_pool_create(0);
+        if (!owned) {
+            return -ENOMEM;
+        }
+        pool = owned;
+    }
+
+    pthread_mutex_lock(&pool->run_lock);
+    int threads = pool->threads;
+    if (chunk == 0) {
+        chunk = count / ((size_t)threads * 8);
+        if (chunk == 0) {
+            chunk = 1;
+        }
+    }
+    size_t per_thread = count / (size_t)threads;
+    size_t extra = count % (size_t)threads;
+    size_t begin = 0;
+    for (int i = 0; i < threads; i++) {
+        size_t len = per_thread + ((size_t)i < extra ? 1 : 0);
+        atomic_init(&pool->ranges[i].next, begin);
+        pool->ranges[i].end = begin + len;
+        begin += len;
+    }
+    pool->fn = fn;
+    pool->ctx = ctx;
+    pool->chunk = chunk;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->active = threads - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    cs_pool_run(pool, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->active > 0) {
+        pthread_cond_wait(&pool->done_cond, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    pthread_mutex_unlock(&pool->run_lock);
+
+    cs_pool_destroy(owned);
+    return 0;
+}
+
+typedef struct {
+    char **entries;
+    cs_entry_fn fn;
+    void *ctx;
+} cs_parallel_entries_ctx;
+
+static inline void cs_parallel_entries_range(size_t begin, size_t end,
+                                             int worker, void *ctx) {
+    cs_parallel_entries_ctx *job = (cs_parallel_entries_ctx *)ctx;
+    for (size_t i = begin; i < end; i++) {
+        job->fn(job->entries[i], i, worker, job->ctx);
+    }
+}
+
+static inline int cs_parallel_for_entries(cs_pool *pool, char **entries,
+                                          size_t count, cs_entry_fn fn,
+                                          void *ctx) {
+    cs_parallel_entries_ctx job = {entries, fn, ctx};
+    return cs_parallel_for(pool, count, 1, cs_parallel_entries_range, &job);
+}
+
+#define CS_HASH_P0 0xa0761d6478bd642fULL
+#define CS_HASH_P1 0xe7037ed1a0b428dbULL
+#define CS_HASH_P2 0x8ebc6af09c88c6e3ULL
+#define CS_HASH_P3 0x589965cc75374cc3ULL
+
+static inline uint64_t cs_hash_read64(const unsigned char *p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint64_t cs_hash_read32(const unsigned char *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint64_t cs_hash_mum(uint64_t a, uint64_t b) {
+#ifdef __SIZEOF_INT128__
+    __extension__ unsigned __int128 product = (unsigned __int128)a * b;
+    return (uint64_t)product ^ (uint64_t)(product >> 64);
+#else
+    uint64_t ha = a >> 32, la = (uint32_t)a;
+    uint64_t hb = b >> 32, lb = (uint32_t)b;
+    uint64_t mid0 = ha * lb, mid1 = hb * la, low = la * lb;
+    uint64_t t = low + (mid0 << 32);
+    uint64_t carry = t < low;
+    uint64_t lo = t + (mid1 << 32);
+    carry += lo < t;
+    uint64_t hi = ha * hb + (mid0 >> 32) + (mid1 >> 32) + carry;
+    return lo ^ hi;
+#endif
+}
+
+static inline uint64_t cs_hash_seed(const void *data, size_t len,
+                                    uint64_t seed) {
+    const unsigned char *p = (const unsigned char *)data;
+    seed ^= cs_hash_mum(seed ^ CS_HASH_P0, CS_HASH_P1);
+    uint64_t a = 0;
+    uint64_t b = 0;
+    if (len <= 16) {
+        if (len >= 4) {
+            size_t mid = (len >> 3) << 2;
+            a = (cs_hash_read32(p) << 32) | cs_hash_read32(p + mid);
+            b = (cs_hash_read32(p + len - 4) << 32) |
+                cs_hash_read32(p + len - 4 - mid);
+        } else if (len > 0) {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) |
+                p[len - 1];
+        }
+    } else {
+        size_t left = len;
+        if (left > 48) {
+            uint64_t s1 = seed;
+            uint64_t s2 = seed;
+            do {
+                seed = cs_hash_mum(cs_hash_read64(p) ^ CS_HASH_P1,
+                                   cs_hash_read64(p + 8) ^ seed);
+                s1 = cs_hash_mum(cs_hash_read64(p + 16) ^ CS_HASH_P2,
+                                 cs_hash_read64(p + 24) ^ s1);
+                s2 = cs_hash_mum(cs_hash_read64(p + 32) ^ CS_HASH_P3,
+                                 cs_hash_read64(p + 40) ^ s2);
+                p += 48;
+                left -= 48;
+            } while (left > 48);
+            seed ^= s1 ^ s2;
+        }
+        while (left > 16) {
+            seed = cs_hash_mum(cs_hash_read64(p) ^ CS_HASH_P1,
+                               cs_hash_read64(p + 8) ^ seed);
+            p += 16;
+            left -= 16;
+        }
+        a = cs_hash_read64(p + left - 16);
+        b = cs_hash_read64(p + left - 8);
+    }
+    return cs_hash_mum(cs_hash_mum(a ^ CS_HASH_P1, b ^ seed) ^ CS_HASH_P0,
+                       (uint64_t)len ^ CS_HASH_P1);
+}
+
+static inline uint64_t cs_hash(const void *data, size_t len) {
+    return cs_hash_seed(data, len, 0);
+}
+
+typedef struct {
+    uint64_t hash;
+    const char *key;
+    size_t len;
+    uint64_t value;
+} cs_map_slot;
+
+typedef struct {
+    cs_map_slot *slots;
+    size_t cap;
+    size_t count;
+    cs_arena keys;
+} cs_map;
+
+static inline int cs_map_init(cs_map *map, size_t expected) {
+    size_t cap = 16;
+    while (cap * 3 < expected * 4) {
+        cap *= 2;
+    }
+    map->slots = (cs_map_slot *)calloc(cap, sizeof(cs_map_slot));
+    map->cap = map->slots ? cap : 0;
+    map->count = 0;
+    cs_arena_init(&map->keys, 0);
+    return map->slots ? 0 : -ENOMEM;
+}
+
+static inline void cs_map_free(cs_map *map) {
+    free(map->slots);
+    cs_arena_free(&map->keys);
+    map->slots = NULL;
+    map->cap = 0;
+    map->count = 0;
+}
+
+static inline cs_map_slot *cs_map_probe(const cs_map *map, uint64_t hash,
+                                        const char *key, size_t len) {
+    size_t mask = map->cap - 1;
+    size_t i = (size_t)hash & mask;
+    for (;;) {
+        cs_map_slot *slot = &map->slots[i];
+        if (!slot->key) {
+            return slot;
+        }
+        if (slot->hash == hash && slot->len == len &&
+            memcmp(slot->key, key, len) == 0) {
+            return slot;
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+static inline int cs_map_grow(cs_map *map) {
+    size_t cap = map->cap * 2;
+    cs_map_slot *slots = (cs_map_slot *)calloc(cap, sizeof(cs_map_slot));
+    if (!slots) {
+        return -ENOMEM;
+    }
+    for (size_t i = 0; i < map->cap; i++) {
+        cs_map_slot *slot = &map->slots[i];
+        if (!slot->key) {
+            continue;
+        }
+        size_t j = (size_t)slot->hash & (cap - 1);
+        while (slots[j].key) {
+            j = (j + 1) & (cap - 1);
+        }
+        slots[j] = *slot;
+    }
+    free(map->slots);
+    map->slots = slots;
+    map->cap = cap;
+    return 0;
+}
+
+static inline uint64_t *cs_map_get(const cs_map *map, const char *key,
+                                   size_t len) {
+    if (map->cap == 0) {
+        return NULL;
+    }
+    cs_map_slot *slot = cs_map_probe(map, cs_hash(key, len), key, len);
+    return slot->key ? &slot->value : NULL;
+}
+
+static inline cs_map_slot *cs_map_insert(cs_map *map, const char *key,
+                                         size_t len) {
+    if (map->cap == 0 && cs_map_init(map, 0) != 0) {
+        return NULL;
+    }
+    uint64_t hash = cs_hash(key, len);
+    cs_map_slot *slot = cs_map_probe(map, hash, key, len);
+    if (slot->key) {
+        return slot;
+    }
+    if ((map->count + 1) * 4 > map->cap * 3) {
+        if (cs_map_grow(map) != 0) {
+            return NULL;
+        }
+        slot = cs_map_probe(map, hash, key, len);
+    }
+    char *copy = cs_arena_strndup(&map->keys, key, len);
+    if (!copy) {
+        return NULL;
+    }
+    slot->hash = hash;
+    slot->key = copy;
+    slot->len = len;
+    slot->value = 0;
+    map->count++;
+    return slot;
+}
+
+static inline uint64_t *cs_map_upsert(cs_map *map, const char *key,
+                                      size_t len) {
+    cs_map_slot *slot = cs_map_insert(map, key, len);
+    return slot ? &slot->value : NULL;
+}
+
+static inline cs_map_slot *cs_map_next(const cs_map *map, size_t *iter) {
+    while (*iter < map->cap) {
+        cs_map_slot *slot = &map->slots[(*iter)++];
+        if (slot->key) {
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+typedef struct {
+    cs_map map;
+} cs_intern;
+
+static inline int cs_intern_init(cs_intern *intern, size_t expected) {
+    return cs_map_init(&intern->map, expected);
+}
+
+static inline const char *cs_intern_str(cs_intern *intern, const char *text,
+                                        size_t len) {
+    cs_map_slot *slot = cs_map_insert(&intern->map, text, len);
+    return slot ? slot->key : NULL;
+}
+
+static inline void cs_intern_free(cs_intern *intern) {
+    cs_map_free(&intern->map);
+}
+
+#ifndef CS_OUT_BUFFER_SIZE
+#define CS_OUT_BUFFER_SIZE (64 * 1024)
+#endif
+
+static const char cs_digit_pairs[] = "00010203040506070809"
+                                     "10111213141516171819"
+                                     "20212223242526272829"
+                                     "30313233343536373839"
+                                     "40414243444546474849"
+                                     "50515253545556575859"
+                                     "60616263646566676869"
+                                     "70717273747576777879"
+                                     "80818283848586878889"
+                                     "90919293949596979899";
+
+static inline size_t cs_format_u64(char *dst, uint64_t value) {
+    char tmp[20];
+    char *p = tmp + sizeof(tmp);
+    while (value >= 100) {
+        size_t pair = (size_t)(value % 100) * 2;
+        value /= 100;
+        p -= 2;
+        memcpy(p, cs_digit_pairs + pair, 2);
+    }
+    if (value >= 10) {
+        p -= 2;
+        memcpy(p, cs_digit_pairs + value * 2, 2);
+    } else {
+        *--p = (char)('0' + value);
+    }
+    size_t len = (size_t)(tmp + sizeof(tmp) - p);
+    memcpy(dst, p, len);
+    return len;
+}
+
+static inline size_t cs_format_i64(char *dst, int64_t value) {
+    if (value < 0) {
+        dst[0] = '-';
+        return 1 + cs_format_u64(dst + 1, (uint64_t)0 - (uint64_t)value);
+    }
+    return cs_format_u64(dst, (uint64_t)value);
+}
+
+static inline size_t cs_format_f64(char *dst, size_t cap, double value,
+                                   int decimals) {
+    static const uint64_t scales[] = {1,         10,         100,
+                                      1000,      10000,      100000,
+                                      1000000,   10000000,   100000000,
+                                      1000000000};
+    if (decimals < 0) {
+        decimals = 6;
+    }
+    double magnitude = value < 0 ? -value : value;
+    int fast = cap >= 40 && decimals <= 9 &&
+               magnitude * (double)scales[decimals] < 9007199254740992.0;
+#ifndef __SIZEOF_INT128__
+    fast = 0;
+#endif
+    if (!fast) {
+        int n = snprintf(dst, cap, "%.*f", decimals, value);
+        return n < 0 ? 0 : ((size_t)n < cap ? (size_t)n : cap - 1);
+    }
+
+    uint64_t scale = scales[decimals];
+    uint64_t bits;
+    memcpy(&bits, &magnitude, sizeof(bits));
+    int exponent = (int)(bits >> 52 & 0x7ff);
+    uint64_t mantissa = bits & (((uint64_t)1 << 52) - 1);
+    if (exponent) {
+        mantissa |= (uint64_t)1 << 52;
+    } else {
+        exponent = 1;
+    }
+    int shift = 1075 - exponent;
+    uint64_t scaled = 0;
+#ifdef __SIZEOF_INT128__
+    if (shift == 0) {
+        scaled = mantissa * scale;
+    } else if (shift <= 84) {
+        __extension__ unsigned __int128 product =
+            (unsigned __int128)mantissa * scale;
+        __extension__ unsigned __int128 half = (unsigned __int128)1
+                                               << (shift - 1);
+        __extension__ unsigned __int128 rest =
+            product & ((half << 1) - 1);
+        scaled = (uint64_t)(product >> shift);
+        if (rest > half || (rest == half && (scaled & 1))) {
+            scaled++;
+        }
+    }
+#endif
+    uint64_t whole = scaled / scale;
+    uint64_t frac = scaled % scale;
+
+    size_t len = 0;
+    if (signbit(value)) {
+        dst[len++] = '-';
+    }
+    len += cs_format_u64(dst + len, whole);
+    if (decimals > 0) {
+        dst[len++] = '.';
+        char digits[20];
+        size_t n = cs_format_u64(digits, frac);
+        memset(dst + len, '0', (size_t)decimals - n);
+        memcpy(dst + len + (size_t)decimals - n, digits, n);
+        len += (size_t)decimals;
+    }
+    dst[len] = '\0';
+    return len;
+}
+
+typedef struct {
+    int fd;
+    int error;
+    char *buf;
+    size_t len;
+    size_t cap;
+} cs_out;
+
+static inline int cs_out_init(cs_out *out, int fd) {
+    out->fd = fd;
+    out->error = 0;
+    out->len = 0;
+    out->cap = CS_OUT_BUFFER_SIZE;
+    out->buf = (char *)malloc(out->cap);
+    if (!out->buf) {
+        out->cap = 0;
+        out->error = -ENOMEM;
+        return -ENOMEM;
+    }
+    return 0;
+}
+
+static inline int cs_out_writev(cs_out *out, struct iovec *iov, int count) {
+    while (count > 0) {
+        ssize_t n = writev(out->fd, iov, count);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            out->error = errno ? -errno : -1;
+            return out->error;
+        }
+        size_t done = (size_t)n;
+        while (count > 0 && done >= iov->iov_len) {
+            done -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char *)iov->iov_base + done;
+            iov->iov_len -= done;
+        }
+    }
+    return 0;
+}
+
+static inline int cs_out_flush(cs_out *out) {
+    if (out->len > 0 && out->error == 0) {
+        struct iovec iov = {out->buf, out->len};
+        cs_out_writev(out, &iov, 1);
+    }
+    out->len = 0;
+    return out->error;
+}
+
+static inline void cs_out_write(cs_out *out, const void *data, size_t len) {
+    if (out->len + len <= out->cap) {
+        memcpy(out->buf + out->len, data, len);
+        out->len += len;
+        return;
+    }
+    if (len < out->cap / 2) {
+        cs_out_flush(out);
+        memcpy(out->buf, data, len);
+        out->len = len;
+        return;
+    }
+    if (out->error == 0) {
+        struct iovec iov[2] = {{out->buf, out->len}, {(void *)data, len}};
+        cs_out_writev(out, out->len ? iov : iov + 1, out->len ? 2 : 1);
+    }
+    out->len = 0;
+}
+
+static inline void cs_out_str(cs_out *out, const char *text) {
+    cs_out_write(out, text, strlen(text));
+}
+
+static inline void cs_out_char(cs_out *out, char c) {
+    if (out->len == out->cap) {
+        cs_out_flush(out);
+    }
+    if (out->cap) {
+        out->buf[out->len++] = c;
+    }
+}
+
+static inline void cs_out_u64(cs_out *out, uint64_t value) {
+    if (out->cap - out->len < 20) {
+        cs_out_flush(out);
+    }
+    if (out->cap >= 20) {
+        out->len += cs_format_u64(out->buf + out->len, value);
+    }
+}
+
+static inline void cs_out_i64(cs_out *out, int64_t value) {
+    if (out->cap - out->len < 21) {
+        cs_out_flush(out);
+    }
+    if (out->cap >= 21) {
+        out->len += cs_format_i64(out->buf + out->len, value);
+    }
+}
+
+static inline void cs_out_f64(cs_out *out, double value, int decimals) {
+    char tmp[352];
+    size_t len = cs_format_f64(tmp, sizeof(tmp), value, decimals);
+    if (len < sizeof(tmp) - 1) {
+        cs_out_write(out, tmp, len);
+        return;
+    }
+    int n = snprintf(NULL, 0, "%.*f", decimals < 0 ? 6 : decimals, value);
+    char *text = n < 0 ? NULL : (char *)malloc((size_t)n + 1);
+    if (!text) {
+        out->error = n < 0 ? -EOVERFLOW : -ENOMEM;
+        return;
+    }
+    snprintf(text, (size_t)n + 1, "%.*f", decimals < 0 ? 6 : decimals, value);
+    cs_out_write(out, text, (size_t)n);
+    free(text);
+}
+
+static inline int cs_out_close(cs_out *out) {
+    int rc = cs_out_flush(out);
+    free(out->buf);
+    out->buf = NULL;
+    out->cap = 0;
+    return rc;
+}
+
+typedef struct {
+    const char *data;
+    size_t len;
+    int escaped;
+} cs_field;
+
+typedef struct {
+    const char *pos;
+    const char *end;
+    const char *block;
+    uint64_t mask;
+    char delim;
+    char quote;
+} cs_fields;
+
+static inline int cs_ctz64(uint64_t value) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(value);
+#else
+    int n = 0;
+    while (!(value & 1)) {
+        value >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+static inline uint64_t cs_fields_block_mask(const char *p, char delim,
+                                            char quote) {
+#if defined(__AVX2__)
+    __m256i d = _mm256_set1_epi8(delim);
+    __m256i q = _mm256_set1_epi8(quote);
+    __m256i nl = _mm256_set1_epi8('\n');
+    uint64_t mask = 0;
+    for (int i = 0; i < 2; i++) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(p + i * 32));
+        __m256i hit = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, d), _mm256_cmpeq_epi8(v, q)),
+            _mm256_cmpeq_epi8(v, nl));
+        mask |= (uint64_t)(uint32_t)_mm256_movemask_epi8(hit) << (i * 32);
+    }
+    return mask;
+#elif defined(__SSE2__)
+    __m128i d = _mm_set1_epi8(delim);
+    __m128i q = _mm_set1_epi8(quote);
+    __m128i nl = _mm_set1_epi8('\n');
+    uint64_t mask = 0;
+    for (int i = 0; i < 4; i++) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + i * 16));
+        __m128i hit = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, d), _mm_cmpeq_epi8(v, q)),
+            _mm_cmpeq_epi8(v, nl));
+        mask |= (uint64_t)(uint16_t)_mm_movemask_epi8(hit) << (i * 16);
+    }
+    return mask;
+#else
+    uint64_t mask = 0;
+    for (int i = 0; i < 64; i++) {
+        char c = p[i];
+        if (c == delim || c == quote || c == '\n') {
+            mask |= (uint64_t)1 << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+static inline const char *cs_fields_scan(cs_fields *parser, const char *p) {
+    char quote = parser->quote ? parser->quote : parser->delim;
+    for (;;) {
+        if (parser->block && p >= parser->block && p < parser->block + 64) {
+            uint64_t mask =
+                parser->mask & (~(uint64_t)0 << (p - parser->block));
+            if (mask) {
+                const char *hit = parser->block + cs_ctz64(mask);
+                return hit < parser->end ? hit : parser->end;
+            }
+            p = parser->block + 64;
+        }
+        if (p >= parser->end) {
+            return parser->end;
+        }
+        parser->block = p;
+        if (parser->end - p >= 64) {
+            parser->mask = cs_fields_block_mask(p, parser->delim, quote);
+        } else {
+            char tail[64] = {0};
+            memcpy(tail, p, (size_t)(parser->end - p));
+            parser->mask = cs_fields_block_mask(tail, parser->delim, quote);
+        }
+    }
+}
+
+static inline void cs_fields_init(cs_fields *parser, const char *data,
+                                  size_t len, char delim) {
+    parser->pos = data;
+    parser->end = data + len;
+    parser->block = NULL;
+    parser->mask = 0;
+    parser->delim = delim;
+    parser->quote = '"';
+}
+
+static inline int cs_fields_row(cs_fields *parser, cs_field *fields,
+                                size_t max_fields, size_t *count) {
+    const char *p = parser->pos;
+    const char *end = parser->end;
+    *count = 0;
+    if (p >= end) {
+        return 0;
+    }
+    char quote = parser->quote ? parser->quote : parser->delim;
+
+    for (;;) {
+        cs_field field = {p, 0, 0};
+        const char *stop = NULL;
+        if (parser->quote && p < end && *p == quote) {
+            const char *q = p + 1;
+            const char *close = end;
+            for (;;) {
+                const char *hit =
+                    (const char *)memchr(q, quote, (size_t)(end - q));
+                if (!hit) {
+                    break;
+                }
+                if (hit + 1 < end && hit[1] == quote) {
+                    field.escaped = 1;
+                    q = hit + 2;
+                    continue;
+                }
+                close = hit;
+                break;
+            }
+            field.data = p + 1;
+            field.len = (size_t)(close - field.data);
+            stop = close < end ? close + 1 : end;
+            while (stop < end && *stop != parser->delim && *stop != '\n') {
+                stop = cs_fields_scan(parser, stop + 1);
+            }
+        } else {
+            stop = cs_fields_scan(parser, p);
+            while (stop < end && *stop == quote && quote != parser->delim) {
+                stop = cs_fields_scan(parser, stop + 1);
+            }
+            field.len = (size_t)(stop - p);
+            if ((stop == end || *stop == '\n') && field.len > 0 &&
+                p[field.len - 1] == '\r') {
+                field.len--;
+            }
+        }
+
+        if (*count < max_fields) {
+            fields[*count] = field;
+        }
+        (*count)++;
+
+        if (stop >= end) {
+            parser->pos = end;
+            return 1;
+        }
+        if (*stop == '\n') {
+            parser->pos = stop + 1;
+            return 1;
+        }
+        p = stop + 1;
+        if (p == end) {
+            cs_field empty = {p, 0, 0};
+            if (*count < max_fields) {
+                fields[*count] = empty;
+            }
+            (*count)++;
+            parser->pos = end;
+            return 1;
+        }
+    }
+}
+
+static inline size_t cs_field_unescape(const cs_field *field, char quote,
+                                       char *dst) {
+    if (!field->escaped) {
+        memcpy(dst, field->data, field->len);
+        return field->len;
+    }
+    size_t len = 0;
+    for (size_t i = 0; i < field->len; i++) {
+        dst[len++] = field->data[i];
+        if (field->data[i] == quote && i + 1 < field->len &&
+            field->data[i + 1] == quote) {
+            i++;
+        }
+    }
+    return len;
+}
+
+static inline int cs_swar_is_8digits(uint64_t chunk) {
+    return ((chunk & 0xF0F0F0F0F0F0F0F0ULL) |
+            (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+           0x3333333333333333ULL;
+}
+
+static inline uint64_t cs_swar_parse_8digits(uint64_t chunk) {
+    chunk -= 0x3030303030303030ULL;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+             (((chunk >> 16) & 0x000000FF000000FFULL) *
+              (1 + (10000ULL << 32)))) >>
+            32;
+    return (uint32_t)chunk;
+}
+
+static inline size_t cs_parse_digits(const char *data, size_t len,
+                                     uint64_t *value, int *overflow) {
+    size_t i = 0;
+    uint64_t result = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    while (i + 8 <= len && i + 8 <= 16) {
+        uint64_t chunk;
+        memcpy(&chunk, data + i, sizeof(chunk));
+        if (!cs_swar_is_8digits(chunk)) {
+            break;
+        }
+        result = result * 100000000ULL + cs_swar_parse_8digits(chunk);
+        i += 8;
+    }
+#endif
+    while (i < len && (unsigned char)(data[i] - '0') < 10) {
+        uint64_t digit = (uint64_t)(data[i] - '0');
+        if (result > (UINT64_MAX - digit) / 10) {
+            *overflow = 1;
+            result = UINT64_MAX;
+        } else if (!*overflow) {
+            result = result * 10 + digit;
+        }
+        i++;
+    }
+    *value = result;
+    return i;
+}
+
+static inline size_t cs_parse_u64(const char *data, size_t len,
+                                  uint64_t *value) {
+    size_t i = 0;
+    if (i < len && data[i] == '+') {
+        i++;
+    }
+    int overflow = 0;
+    size_t digits = cs_parse_digits(data + i, len - i, value, &overflow);
+    if (digits == 0) {
+        *value = 0;
+        return 0;
+    }
+    if (overflow) {
+        errno = ERANGE;
+    }
+    return i + digits;
+}
+
+static inline size_t cs_parse_i64(const char *data, size_t len,
+                                  int64_t *value) {
+    size_t i = 0;
+    int negative = 0;
+    if (i < len && (data[i] == '+' || data[i] == '-')) {
+        negative = data[i] == '-';
+        i++;
+    }
+    uint64_t magnitude = 0;
+    int overflow = 0;
+    size_t digits = cs_parse_digits(data + i, len - i, &magnitude, &overflow);
+    if (digits == 0) {
+        *value = 0;
+        return 0;
+    }
+    uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+    if (overflow || magnitude > limit) {
+        errno = ERANGE;
+        *value = negative ? INT64_MIN : INT64_MAX;
+    } else if (negative) {
+        *value = magnitude == limit ? INT64_MIN : -(int64_t)magnitude;
+    } else {
+        *value = (int64_t)magnitude;
+    }
+    return i + digits;
+}
+
+static inline size_t cs_parse_f64_slow(const char *data, size_t len,
+                                       double *value) {
+    size_t span = 0;
+    while (span < len && (data[span] == ' ' || data[span] == '\t')) {
+        span++;
+    }
+    while (span < len) {
+        char c = data[span];
+        char lower = (char)(c | 0x20);
+        if (!((c >= '0' && c <= '9') || (lower >= 'a' && lower <= 'z') ||
+              c == '.' || c == '+' || c == '-' || c == '_' || c == '(' ||
+              c == ')')) {
+            break;
+        }
+        span++;
+    }
+    len = span;
+
+    char local[128];
+    char *copy = len < sizeof(local) ? local : (char *)malloc(len + 1);
+    if (!copy) {
+        *value = 0;
+        return 0;
+    }
+    memcpy(copy, data, len);
+    copy[len] = '\0';
+    const char *point = localeconv()->decimal_point;
+    if (point && point[0] != '.' && point[0] != '\0' && point[1] == '\0') {
+        char *dot = memchr(copy, '.', len);
+        if (dot) {
+            *dot = point[0];
+        }
+    }
+    char *end = NULL;
+    *value = strtod(copy, &end);
+    size_t consumed = (size_t)(end - copy);
+    if (copy != local) {
+        free(copy);
+    }
+    return consumed;
+}
+
+static inline size_t cs_parse_f64(const char *data, size_t len,
+                                  double *value) {
+    static const double powers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                    1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                    1e18, 1e19, 1e20, 1e21, 1e22};
+    size_t i = 0;
+    int negative = 0;
+    if (i < len && (data[i] == '+' || data[i] == '-')) {
+        negative = data[i] == '-';
+        i++;
+    }
+    if (i < len && (data[i] == 'i' || data[i] == 'I' || data[i] == 'n' ||
+                    data[i] == 'N')) {
+        return cs_parse_f64_slow(data, len < 16 ? len : 16, value);
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int dropped = 0;
+    int64_t exponent = 0;
+    size_t start = i;
+    while (i < len && (unsigned char)(data[i] - '0') < 10) {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (uint64_t)(data[i] - '0');
+            digits += mantissa != 0;
+        } else {
+            exponent++;
+            dropped |= data[i] != '0';
+        }
+        i++;
+    }
+    size_t int_digits = i - start;
+    size_t frac_digits = 0;
+    if (i < len && data[i] == '.') {
+        i++;
+        size_t frac_start = i;
+        while (i < len && (unsigned char)(data[i] - '0') < 10) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (uint64_t)(data[i] - '0');
+                digits += mantissa != 0;
+                exponent--;
+            } else {
+                dropped |= data[i] != '0';
+            }
+            i++;
+        }
+        frac_digits = i - frac_start;
+    }
+    if (int_digits == 0 && frac_digits == 0) {
+        *value = 0;
+        return 0;
+    }
+
+    if (i < len && (data[i] == 'e' || data[i] == 'E')) {
+        size_t j = i + 1;
+        int exp_negative = 0;
+        if (j < len && (data[j] == '+' || data[j] == '-')) {
+            exp_negative = data[j] == '-';
+            j++;
+        }
+        if (j < len && (unsigned char)(data[j] - '0') < 10) {
+            int64_t exp_value = 0;
+            while (j < len && (unsigned char)(data[j] - '0') < 10) {
+                if (exp_value < 100000) {
+                    exp_value = exp_value * 10 + (data[j] - '0');
+                }
+                j++;
+            }
+            exponent += exp_negative ? -exp_value : exp_value;
+            i = j;
+        }
+    }
+
+    if (mantissa == 0) {
+        *value = negative ? -0.0 : 0.0;
+        return i;
+    }
+    if (!dropped && mantissa <= (1ULL << 53)) {
+        double result = (double)mantissa;
+        int exact = 1;
+        if (exponent < 0 && exponent >= -22) {
+            result /= powers[-exponent];
+        } else if (exponent >= 0 && exponent <= 22) {
+            result *= powers[exponent];
+        } else if (exponent > 22 && exponent <= 22 + 15) {
+            result *= powers[exponent - 22];
+            if (result > (double)(1ULL << 53)) {
+                exact = 0;
+            } else {
+                result *= 1e22;
+            }
+        } else {
+            exact = 0;
+        }
+        if (exact) {
+            *value = negative ? -result : result;
+            return i;
+        }
+    }
+    cs_parse_f64_slow(data, i, value);
+    return i;
+}
+
+#define CS_JSON_ERROR -1
+#define CS_JSON_END 0
+#define CS_JSON_OBJECT_START 1
+#define CS_JSON_OBJECT_END 2
+#define CS_JSON_ARRAY_START 3
+#define CS_JSON_ARRAY_END 4
+#define CS_JSON_KEY 5
+#define CS_JSON_STRING 6
+#define CS_JSON_NUMBER 7
+#define CS_JSON_TRUE 8
+#define CS_JSON_FALSE 9
+#define CS_JSON_NULL 10
+
+#ifndef CS_JSON_MAX_DEPTH
+#define CS_JSON_MAX_DEPTH 128
+#endif
+
+typedef struct {
+    int type;
+    int depth;
+    int escaped;
+    const char *data;
+    size_t len;
+} cs_json_token;
+
+typedef struct {
+    const char *pos;
+    const char *end;
+    int depth;
+    int state;
+    char stack[CS_JSON_MAX_DEPTH];
+} cs_json;
+
+#define CS_JSON_STATE_VALUE 0
+#define CS_JSON_STATE_VALUE_OR_END 1
+#define CS_JSON_STATE_KEY 2
+#define CS_JSON_STATE_KEY_OR_END 3
+#define CS_JSON_STATE_COMMA_OR_END 4
+
+static inline const char *cs_find2(const char *p, const char *end, char a,
+                                   char b) {
+#if defined(__AVX2__)
+    __m256i va = _mm256_set1_epi8(a);
+    __m256i vb = _mm256_set1_epi8(b);
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)p);
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(
+            _mm256_cmpeq_epi8(v, va), _mm256_cmpeq_epi8(v, vb)));
+        if (mask) {
+            return p + cs_ctz64(mask);
+        }
+        p += 32;
+    }
+#elif defined(__SSE2__)
+    __m128i va = _mm_set1_epi8(a);
+    __m128i vb = _mm_set1_epi8(b);
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb)));
+        if (mask) {
+            return p + cs_ctz64(mask);
+        }
+        p += 16;
+    }
+#endif
+    while (p < end && *p != a && *p != b) {
+        p++;
+    }
+    return p;
+}
+
+static inline void cs_json_init(cs_json *json, const char *data, size_t len) {
+    json->pos = data;
+    json->end = data + len;
+    json->depth = 0;
+    json->state = CS_JSON_STATE_VALUE;
+}
+
+static inline int cs_json_is_ws(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static inline void cs_json_skip_ws(cs_json *json) {
+    const char *p = json->pos;
+    const char *end = json->end;
+    if (p >= end || !cs_json_is_ws(*p)) {
+        return;
+    }
+#if defined(__AVX2__)
+    __m256i space = _mm256_set1_epi8(' ');
+    __m256i nl = _mm256_set1_epi8('\n');
+    __m256i cr = _mm256_set1_epi8('\r');
+    __m256i tab = _mm256_set1_epi8('\t');
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)p);
+        __m256i ws = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, space),
+                            _mm256_cmpeq_epi8(v, nl)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, cr),
+                            _mm256_cmpeq_epi8(v, tab)));
+        uint32_t mask = ~(uint32_t)_mm256_movemask_epi8(ws);
+        if (mask) {
+            json->pos = p + cs_ctz64(mask);
+            return;
+        }
+        p += 32;
+    }
+#elif defined(__SSE2__)
+    __m128i space = _mm_set1_epi8(' ');
+    __m128i nl = _mm_set1_epi8('\n');
+    __m128i cr = _mm_set1_epi8('\r');
+    __m128i tab = _mm_set1_epi8('\t');
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        __m128i ws = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, nl)),
+            _mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, tab)));
+        uint32_t mask = ~(uint32_t)_mm_movemask_epi8(ws) & 0xffff;
+        if (mask) {
+            json->pos = p + cs_ctz64(mask);
+            return;
+        }
+        p += 16;
+    }
+#endif
+    while (p < end && cs_json_is_ws(*p)) {
+        p++;
+    }
+    json->pos = p;
+}
+
+static inline int cs_json_at_delim(const char *p, const char *end) {
+    return p >= end || cs_json_is_ws(*p) || *p == ',' || *p == ']' ||
+           *p == '}';
+}
+
+static inline const char *cs_json_digits(const char *p, const char *end) {
+    while (p < end && *p >= '0' && *p <= '9') {
+        p++;
+    }
+    return p;
+}
+
+static inline const char *cs_json_number_end(const char *p,
+                                             const char *end) {
+    if (p < end && *p == '-') {
+        p++;
+    }
+    if (p >= end || *p < '0' || *p > '9') {
+        return NULL;
+    }
+    p = *p == '0' ? p + 1 : cs_json_digits(p, end);
+    if (p < end && *p == '.') {
+        const char *digits = ++p;
+        p = cs_json_digits(p, end);
+        if (p == digits) {
+            return NULL;
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        if (p < end && (*p == '+' || *p == '-')) {
+            p++;
+        }
+        const char *digits = p;
+        p = cs_json_digits(p, end);
+        if (p == digits) {
+            return NULL;
+        }
+    }
+    return cs_json_at_delim(p, end) ? p : NULL;
+}
+
+static inline int cs_json_fail(cs_json *json, cs_json_token *token) {
+    token->type = CS_JSON_ERROR;
+    token->data = json->pos;
+    token->len = 0;
+    json->pos = json->end;
+    json->state = CS_JSON_STATE_VALUE;
+    json->depth = 0;
+    return CS_JSON_ERROR;
+}
+
+static inline int cs_json_string(cs_json *json, cs_json_token *token,
+                                 int type) {
+    const char *p = json->pos + 1;
+    token->escaped = 0;
+    for (;;) {
+        const char *hit = cs_find2(p, json->end, '"', '\\');
+        if (hit >= json->end) {
+            return cs_json_fail(json, token);
+        }
+        if (*hit == '\\') {
+            token->escaped = 1;
+            p = hit + 2;
+            continue;
+        }
+        token->type = type;
+        token->data = json->pos + 1;
+        token->len = (size_t)(hit - token->data);
+        json->pos = hit + 1;
+        return type;
+    }
+}
+
+static inline int cs_json_close(cs_json *json, cs_json_token *token, char c) {
+    char open = c == '}' ? '{' : '[';
+    if (json->depth == 0 || json->stack[json->depth - 1] != open) {
+        return cs_json_fail(json, token);
+    }
+    json->depth--;
+    token->type = c == '}' ? CS_JSON_OBJECT_END : CS_JSON_ARRAY_END;
+    token->depth = json->depth;
+    token->data = json->pos;
+    token->len = 1;
+    json->pos++;
+    json->state =
+        json->depth > 0 ? CS_JSON_STATE_COMMA_OR_END : CS_JSON_STATE_VALUE;
+    return token->type;
+}
+
+static inline int cs_json_next(cs_json *json, cs_json_token *token) {
+    token->escaped = 0;
+    cs_json_skip_ws(json);
+    token->depth = json->depth;
+    if (json->pos >= json->end) {
+        if (json->depth > 0 || json->state != CS_JSON_STATE_VALUE) {
+            return cs_json_fail(json, token);
+        }
+        token->type = CS_JSON_END;
+        token->data = json->pos;
+        token->len = 0;
+        return CS_JSON_END;
+    }
+
+    char c = *json->pos;
+    if (json->state == CS_JSON_STATE_COMMA_OR_END) {
+        if (c == '}' || c == ']') {
+            return cs_json_close(json, token, c);
+        }
+        if (c != ',') {
+            return cs_json_fail(json, token);
+        }
+        json->pos++;
+        cs_json_skip_ws(json);
+        if (json->pos >= json->end) {
+            return cs_json_fail(json, token);
+        }
+        c = *json->pos;
+        json->state = json->stack[json->depth - 1] == '{'
+                          ? CS_JSON_STATE_KEY
+                          : CS_JSON_STATE_VALUE;
+    }
+
+    if (json->state == CS_JSON_STATE_KEY_OR_END && c == '}') {
+        return cs_json_close(json, token, c);
+    }
+    if (json->state == CS_JSON_STATE_VALUE_OR_END && c == ']') {
+        return cs_json_close(json, token, c);
+    }
+    if (json->state == CS_JSON_STATE_KEY ||
+        json->state == CS_JSON_STATE_KEY_OR_END) {
+        if (c != '"' || cs_json_string(json, token, CS_JSON_KEY) < 0) {
+            return cs_json_fail(json, token);
+        }
+        cs_json_skip_ws(json);
+        if (json->pos >= json->end || *json->pos != ':') {
+            return cs_json_fail(json, token);
+        }
+        json->pos++;
+        json->state = CS_JSON_STATE_VALUE;
+        return CS_JSON_KEY;
+    }
+
+    const char *start = json->pos;
+    int type = CS_JSON_ERROR;
+    if (c == '{' || c == '[') {
+        if (json->depth >= CS_JSON_MAX_DEPTH) {
+            return cs_json_fail(json, token);
+        }
+        json->stack[json->depth++] = c;
+        json->pos++;
+        json->state = c == '{' ? CS_JSON_STATE_KEY_OR_END
+                               : CS_JSON_STATE_VALUE_OR_END;
+        token->type = c == '{' ? CS_JSON_OBJECT_START : CS_JSON_ARRAY_START;
+        token->data = start;
+        token->len = 1;
+        return token->type;
+    }
+    if (c == '"') {
+        if (cs_json_string(json, token, CS_JSON_STRING) < 0) {
+            return CS_JSON_ERROR;
+        }
+        type = CS_JSON_STRING;
+    } else if (c == '-' || (c >= '0' && c <= '9')) {
+        const char *p = cs_json_number_end(start, json->end);
+        if (!p) {
+            return cs_json_fail(json, token);
+        }
+        type = CS_JSON_NUMBER;
+        token->data = start;
+        token->len = (size_t)(p - start);
+        json->pos = p;
+    } else {
+        static const char *const literals[] = {"true", "false", "null"};
+        static const int types[] = {CS_JSON_TRUE, CS_JSON_FALSE, CS_JSON_NULL};
+        for (int i = 0; i < 3; i++) {
+            size_t n = strlen(literals[i]);
+            if ((size_t)(json->end - start) >= n &&
+                memcmp(start, literals[i], n) == 0 &&
+                cs_json_at_delim(start + n, json->end)) {
+                type = types[i];
+                token->data = start;
+                token->len = n;
+                json->pos = start + n;
+                break;
+            }
+        }
+        if (type == CS_JSON_ERROR) {
+            return cs_json_fail(json, token);
+        }
+    }
+    token->type = type;
+    json->state =
+        json->depth > 0 ? CS_JSON_STATE_COMMA_OR_END : CS_JSON_STATE_VALUE;
+    return type;
+}
+
+static inline int cs_json_skip(cs_json *json, const cs_json_token *token) {
+    if (token->type != CS_JSON_OBJECT_START &&
+        token->type != CS_JSON_ARRAY_START) {
+        return token->type == CS_JSON_ERROR ? CS_JSON_ERROR : 0;
+    }
+    cs_json_token inner;
+    for (;;) {
+        int type = cs_json_next(json, &inner);
+        if (type <= 0) {
+            return CS_JSON_ERROR;
+        }
+        if ((type == CS_JSON_OBJECT_END || type == CS_JSON_ARRAY_END) &&
+            inner.depth == token->depth) {
+            return 0;
+        }
+    }
+}
+
+static inline int cs_json_find(const char *data, size_t len, const char *path,
+                               cs_json_token *out) {
+    cs_json json;
+    cs_json_init(&json, data, len);
+    cs_json_token token;
+    if (cs_json_next(&json, &token) <= 0) {
+        return -EINVAL;
+    }
+
+    const char *segment = path;
+    while (*segment) {
+        const char *dot = strchr(segment, '.');
+        size_t seg_len = dot ? (size_t)(dot - segment) : strlen(segment);
+        int found = 0;
+        if (token.type == CS_JSON_OBJECT_START) {
+            for (;;) {
+                cs_json_token key;
+                int type = cs_json_next(&json, &key);
+                if (type == CS_JSON_OBJECT_END) {
+                    break;
+                }
+                if (type != CS_JSON_KEY || cs_json_next(&json, &token) <= 0) {
+                    return -EINVAL;
+                }
+                if (key.len == seg_len &&
+                    memcmp(key.data, segment, seg_len) == 0) {
+                    found = 1;
+                    break;
+                }
+                if (cs_json_skip(&json, &token) != 0) {
+                    return -EINVAL;
+                }
+            }
+        } else if (token.type == CS_JSON_ARRAY_START) {
+            uint64_t index = 0;
+            if (cs_parse_u64(segment, seg_len, &index) != seg_len) {
+                return -ENOENT;
+            }
+            for (uint64_t i = 0;; i++) {
+                int type = cs_json_next(&json, &token);
+                if (type == CS_JSON_ARRAY_END) {
+                    break;
+                }
+                if (type <= 0) {
+                    return -EINVAL;
+                }
+                if (i == index) {
+                    found = 1;
+                    break;
+                }
+                if (cs_json_skip(&json, &token) != 0) {
+                    return -EINVAL;
+                }
+            }
+        }
+        if (!found) {
+            return -ENOENT;
+        }
+        segment = dot ? dot + 1 : segment + seg_len;
+    }
+
+    if (token.type == CS_JSON_OBJECT_START ||
+        token.type == CS_JSON_ARRAY_START) {
+        if (cs_json_skip(&json, &token) != 0) {
+            return -EINVAL;
+        }
+        token.len = (size_t)(json.pos - token.data);
+    }
+    *out = token;
+    return 0;
+}
+
+static inline size_t cs_json_utf8(char *dst, uint32_t cp) {
+    if (cp < 0x80) {
+        dst[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        dst[0] = (char)(0xC0 | (cp >> 6));
+        dst[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        dst[0] = (char)(0xE0 | (cp >> 12));
+        dst[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        dst[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    dst[0] = (char)(0xF0 | (cp >> 18));
+    dst[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    dst[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    dst[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+static inline int cs_json_hex4(const char *p, const char *end, uint32_t *out) {
+    if (end - p < 4) {
+        return -1;
+    }
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = p[i];
+        int digit = c >= '0' && c <= '9'   ? c - '0'
+                    : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                    : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                                           : -1;
+        if (digit < 0) {
+            return -1;
+        }
+        value = value * 16 + (uint32_t)digit;
+    }
+    *out = value;
+    return 0;
+}
+
+static inline size_t cs_json_unescape(const cs_json_token *token, char *dst) {
+    if (!token->escaped) {
+        memcpy(dst, token->data, token->len);
+        return token->len;
+    }
+    const char *p = token->data;
+    const char *end = token->data + token->len;
+    size_t len = 0;
+    while (p < end) {
+        if (*p != '\\' || p + 1 >= end) {
+            dst[len++] = *p++;
+            continue;
+        }
+        char c = p[1];
+        p += 2;
+        switch (c) {
+        case 'b':
+            dst[len++] = '\b';
+            break;
+        case 'f':
+            dst[len++] = '\f';
+            break;
+        case 'n':
+            dst[len++] = '\n';
+            break;
+        case 'r':
+            dst[len++] = '\r';
+            break;
+        case 't':
+            dst[len++] = '\t';
+            break;
+        case 'u': {
+            uint32_t cp = 0;
+            if (cs_json_hex4(p, end, &cp) != 0) {
+                dst[len++] = c;
+                break;
+            }
+            p += 4;
+            uint32_t low = 0;
+            if (cp >= 0xD800 && cp < 0xDC00 && end - p >= 6 && p[0] == '\\' &&
+                p[1] == 'u' && cs_json_hex4(p + 2, end, &low) == 0 &&
+                low >= 0xDC00 && low < 0xE000) {
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                p += 6;
+            }
+            len += cs_json_utf8(dst + len, cp);
+            break;
+        }
+        default:
+            dst[len++] = c;
+            break;
+        }
+    }
+    return len;
+}
+
+#if defined(__linux__) && !defined(CS_FICLONE)
+#define CS_FICLONE _IOW(0x94, 9, int)
+#endif
+
+#ifndef SPLICE_F_MOVE
+#define SPLICE_F_MOVE 1
+#endif
+
+static inline int cs_copy_fd(int in_fd, int out_fd) {
+    struct stat in_st;
+    struct stat out_st;
+    if (fstat(in_fd, &in_st) != 0 || fstat(out_fd, &out_st) != 0) {
+        return errno ? -errno : -1;
+    }
+#if defined(__linux__)
+#if defined(SYS_copy_file_range)
+    int use_range = S_ISREG(in_st.st_mode) && S_ISREG(out_st.st_mode);
+#else
+    int use_range = 0;
+#endif
+#if defined(SYS_splice)
+    int use_splice = S_ISFIFO(in_st.st_mode) || S_ISFIFO(out_st.st_mode);
+#else
+    int use_splice = 0;
+#endif
+    int use_sendfile = S_ISREG(in_st.st_mode);
+    for (;;) {
+        ssize_t n = -1;
+        if (use_range) {
+#if defined(SYS_copy_file_range)
+            n = (ssize_t)syscall(SYS_copy_file_range, in_fd, NULL, out_fd,
+                                 NULL, (size_t)1 << 30, 0u);
+#endif
+            if (n < 0 && errno != EINTR) {
+                use_range = 0;
+                continue;
+            }
+        } else if (use_splice) {
+#if defined(SYS_splice)
+            n = (ssize_t)syscall(SYS_splice, in_fd, NULL, out_fd, NULL,
+                                 (size_t)1 << 20, (unsigned)SPLICE_F_MOVE);
+#endif
+            if (n < 0 && errno != EINTR) {
+                use_splice = 0;
+                continue;
+            }
+        } else if (use_sendfile) {
+            n = sendfile(out_fd, in_fd, NULL, 1 << 30);
+            if (n < 0 && errno != EINTR) {
+                use_sendfile = 0;
+                continue;
+            }
+        } else {
+            break;
+        }
+        if (n == 0) {
+            return 0;
+        }
+    }
+#endif
+
+    char *buf = (char *)malloc(CS_READER_BUFFER_SIZE);
+    if (!buf) {
+        return -ENOMEM;
+    }
+    int rc = 0;
+    for (;;) {
+        ssize_t n = read(in_fd, buf, CS_READER_BUFFER_SIZE);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            rc = n < 0 ? -errno : 0;
+            break;
+        }
+        for (ssize_t done = 0; done < n;) {
+            ssize_t w = write(out_fd, buf + done, (size_t)(n - done));
+            if (w < 0 && errno == EINTR) {
+                continue;
+            }
+            if (w < 0) {
+                rc = -errno;
+                break;
+            }
+            done += w;
+        }
+        if (rc != 0) {
+            break;
+        }
+    }
+    free(buf);
+    return rc;
+}
+
+static inline int cs_copy_file(const char *src, const char *dst) {
+    int in_fd = open(src, O_RDONLY | O_CLOEXEC);
+    if (in_fd < 0) {
+        return errno ? -errno : -1;
+    }
+    struct stat st;
+    if (fstat(in_fd, &st) != 0) {
+        int err = errno ? -errno : -1;
+        close(in_fd);
+        return err;
+    }
+    mode_t mode = S_ISREG(st.st_mode) ? (st.st_mode & 0777) : 0666;
+    int out_fd = open(dst, O_WRONLY | O_CREAT | O_CLOEXEC, mode);
+    if (out_fd < 0) {
+        int err = errno ? -errno : -1;
+        close(in_fd);
+        return err;
+    }
+    struct stat out_st;
+    int rc = 0;
+    if (fstat(out_fd, &out_st) != 0) {
+        rc = errno ? -errno : -1;
+    } else if (out_st.st_dev == st.st_dev && out_st.st_ino == st.st_ino) {
+        rc = -EINVAL;
+    } else if (S_ISREG(out_st.st_mode) && ftruncate(out_fd, 0) != 0) {
+        rc = errno ? -errno : -1;
+    }
+    if (rc != 0) {
+        close(in_fd);
+        close(out_fd);
+        return rc;
+    }
+
+    rc = -1;
+#if defined(__linux__)
+    if (S_ISREG(st.st_mode) && ioctl(out_fd, CS_FICLONE, in_fd) == 0) {
+        rc = 0;
+    }
+#endif
+    if (rc != 0) {
+        rc = cs_copy_fd(in_fd, out_fd);
+    }
+    close(in_fd);
+    if (close(out_fd) != 0 && rc == 0) {
+        rc = errno ? -errno : -1;
+    }
+    return rc;
+}
+
+static inline int cs_write_file_atomic(const char *path, const void *data,
+                                       size_t len) {
+    const char *slash = strrchr(path, '/');
+    size_t dir_len = slash ? (size_t)(slash - path) : 0;
+    const char *base = slash ? slash + 1 : path;
+    size_t tmp_len = dir_len + strlen(base) + 16;
+    char *tmp = (char *)malloc(tmp_len);
+    if (!tmp) {
+        return -ENOMEM;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    uint64_t seed = (uint64_t)now.tv_nsec ^ (uint64_t)now.tv_sec << 30 ^
+                    (uint64_t)getpid() << 40 ^ (uint64_t)(uintptr_t)tmp;
+    int fd = -1;
+    for (int attempt = 0; fd < 0 && attempt < 100; attempt++) {
+        seed = cs_hash_mum(seed + 0x9e3779b97f4a7c15ull, 0xbf58476d1ce4e5b9ull);
+        unsigned suffix = (unsigned)(seed & 0xffffff);
+        if (slash) {
+            snprintf(tmp, tmp_len, "%.*s/.%s.%06x", (int)dir_len, path, base,
+                     suffix);
+        } else {
+            snprintf(tmp, tmp_len, ".%s.%06x", base, suffix);
+        }
+        fd = open(tmp, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+        if (fd < 0 && errno != EEXIST) {
+            break;
+        }
+    }
+    if (fd < 0) {
+        int err = errno ? -errno : -1;
+        free(tmp);
+        return err;
+    }
+
+    struct stat st;
+    int keep_mode = stat(path, &st) == 0;
+
+    int rc = 0;
+    const char *bytes = (const char *)data;
+    for (size_t done = 0; done < len;) {
+        ssize_t n = write(fd, bytes + done, len - done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            rc = -errno;
+            break;
+        }
+        done += (size_t)n;
+    }
+    if (rc == 0 && keep_mode && fchmod(fd, st.st_mode & 07777) != 0) {
+        rc = errno ? -errno : -1;
+    }
+    if (rc == 0 && fsync(fd) != 0) {
+        rc = errno ? -errno : -1;
+    }
+    if (close(fd) != 0 && rc == 0) {
+        rc = errno ? -errno : -1;
+    }
+    if (rc == 0 && rename(tmp, path) != 0) {
+        rc = errno ? -errno : -1;
+    }
+    if (rc != 0) {
+        unlink(tmp);
+        free(tmp);
+        return rc;
+    }
+    free(tmp);
+
+    int dir_fd = -1;
+    if (slash) {
+        char *dir = (char *)malloc(dir_len + 2);
+        if (dir) {
+            memcpy(dir, path, dir_len);
+            dir[dir_len ? dir_len : 1] = '\0';
+            if (dir_len == 0) {
+                dir[0] = '/';
+            }
+            dir_fd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            free(dir);
+        }
+    } else {
+        dir_fd = open(".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    }
+    if (dir_fd >= 0) {
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+    return 0;
+}
+
+static inline int cs_pipeline(char **const *argvs, size_t count, int in_fd,
+                              int out_fd, int *statuses) {
+    pid_t *pids = (pid_t *)calloc(count ? count : 1, sizeof(pid_t));
+    if (!pids) {
+        return -ENOMEM;
+    }
+
+    int rc = 0;
+    int prev_read = in_fd;
+    size_t started = 0;
+    for (size_t i = 0; i < count; i++) {
+        int fds[2] = {-1, -1};
+        if (i + 1 < count && cs_cmd_pipe(fds) != 0) {
+            rc = errno ? -errno : -1;
+            break;
+        }
+        int stage_out = i + 1 < count ? fds[1] : out_fd;
+
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        if (prev_read >= 0) {
+            posix_spawn_file_actions_adddup2(&actions, prev_read,
+                                             STDIN_FILENO);
+        }
+        if (stage_out >= 0) {
+            posix_spawn_file_actions_adddup2(&actions, stage_out,
+                                             STDOUT_FILENO);
+        }
+        int spawn_rc = posix_spawnp(&pids[i], argvs[i][0], &actions, NULL,
+                                    argvs[i], environ);
+        posix_spawn_file_actions_destroy(&actions);
+
+        if (prev_read >= 0 && prev_read != in_fd) {
+            close(prev_read);
+        }
+        if (fds[1] >= 0) {
+            close(fds[1]);
+        }
+        prev_read = fds[0];
+        if (spawn_rc != 0) {
+            rc = -spawn_rc;
+            if (statuses) {
+                statuses[i] = rc;
+            }
+            break;
+        }
+        started++;
+    }
+    if (prev_read >= 0 && prev_read != in_fd) {
+        close(prev_read);
+    }
+
+    for (size_t i = 0; i < started; i++) {
+        int status = 0;
+        while (waitpid(pids[i], &status, 0) < 0 && errno == EINTR) {
+        }
+        if (statuses) {
+            statuses[i] = WIFEXITED(status)     ? WEXITSTATUS(status)
+                          : WIFSIGNALED(status) ? 128 + WTERMSIG(status)
+                                                : status;
+        }
+    }
+    free(pids);
+    return rc;
+}
+
+#ifndef CS_URING_ENTRIES
+#define CS_URING_ENTRIES 256
+#endif
+
+#ifndef CS_READ_MANY_CHUNK
+#define CS_READ_MANY_CHUNK 4096
+#endif
+
+#define CS_READ_MANY_OPEN 1
+#define CS_READ_MANY_STATX 2
+#define CS_READ_MANY_READ 3
+#define CS_READ_MANY_CLOSE 4
+
+static inline int cs_read_many_grow(char **data, size_t *cap, size_t need) {
+    size_t next = *cap ? *cap : 4096;
+    while (next < need) {
+        next *= 2;
+    }
+    if (next == *cap) {
+        return 0;
+    }
+    char *grown = (char *)realloc(*data, next);
+    if (!grown) {
+        return -ENOMEM;
+    }
+    *data = grown;
+    *cap = next;
+    return 0;
+}
+
+static inline int cs_read_many_one(const char *path, cs_buffer *out) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return errno ? -errno : -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int err = errno ? -errno : -1;
+        close(fd);
+        return err;
+    }
+    int regular = S_ISREG(st.st_mode) && st.st_size > 0;
+    size_t size = regular ? (size_t)st.st_size : 0;
+    char *data = NULL;
+    size_t cap = 0;
+    size_t len = 0;
+    int rc = cs_read_many_grow(&data, &cap, size + 2);
+    while (rc == 0) {
+        if (len + 1 >= cap) {
+            rc = cs_read_many_grow(&data, &cap, cap * 2);
+            continue;
+        }
+        size_t want = cap - 1 - len;
+        ssize_t n = read(fd, data + len, want);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            rc = -errno;
+            break;
+        }
+        len += (size_t)n;
+        if (n == 0 || (regular && (size_t)n < want)) {
+            break;
+        }
+    }
+    close(fd);
+    if (rc != 0) {
+        free(data);
+        return rc;
+    }
+    data[len] = '\0';
+    out->data = data;
+    out->len = len;
+    return 0;
+}
+
+typedef struct {
+    char *const *paths;
+    cs_buffer *results;
+    int *errors;
+} cs_read_many_job;
+
+static inline void cs_read_many_range(size_t begin, size_t end, int worker,
+                                      void *ctx) {
+    (void)worker;
+    cs_read_many_job *job = (cs_read_many_job *)ctx;
+    for (size_t i = begin; i < end; i++) {
+        job->errors[i] = cs_read_many_one(job->paths[i], &job->results[i]);
+    }
+}
+
+#if defined(CS_HAVE_IO_URING)
+typedef struct {
+    int fd;
+    unsigned entries;
+    unsigned tail;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring;
+    size_t cq_ring_size;
+    size_t sqes_size;
+} cs_uring;
+
+static inline void cs_uring_free(cs_uring *ring) {
+    if (ring->sqes) {
+        munmap(ring->sqes, ring->sqes_size);
+    }
+    if (ring->cq_ring && ring->cq_ring != ring->sq_ring) {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    if (ring->sq_ring) {
+        munmap(ring->sq_ring, ring->sq_ring_size);
+    }
+    if (ring->fd >= 0) {
+        close(ring->fd);
+    }
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = -1;
+}
+
+static inline int cs_uring_init(cs_uring *ring, unsigned entries) {
+    memset(ring, 0, sizeof(*ring));
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd < 0) {
+        ring->fd = -1;
+        return errno ? -errno : -1;
+    }
+    if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+        cs_uring_free(ring);
+        return -ENOSYS;
+    }
+
+    ring->entries = params.sq_entries;
+    ring->sq_ring_size =
+        params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = params.cq_off.cqes +
+                         params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_ring_size > ring->sq_ring_size) {
+            ring->sq_ring_size = ring->cq_ring_size;
+        }
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, ring->fd,
+                         IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED) {
+        ring->sq_ring = NULL;
+        int err = errno ? -errno : -1;
+        cs_uring_free(ring);
+        return err;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_ring = ring->sq_ring;
+    } else {
+        ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, ring->fd,
+                             IORING_OFF_CQ_RING);
+        if (ring->cq_ring == MAP_FAILED) {
+            ring->cq_ring = NULL;
+            int err = errno ? -errno : -1;
+            cs_uring_free(ring);
+            return err;
+        }
+    }
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = (struct io_uring_sqe *)mmap(
+        NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        ring->sqes = NULL;
+        int err = errno ? -errno : -1;
+        cs_uring_free(ring);
+        return err;
+    }
+
+    char *sq = (char *)ring->sq_ring;
+    char *cq = (char *)ring->cq_ring;
+    ring->sq_head = (unsigned *)(sq + params.sq_off.head);
+    ring->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned *)(sq + params.sq_off.array);
+    ring->cq_head = (unsigned *)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+    ring->tail = *ring->sq_tail;
+    return 0;
+}
+
+static inline struct io_uring_sqe *cs_uring_sqe(cs_uring *ring,
+                                                uint64_t user_data) {
+    unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    if (ring->tail - head >= ring->entries) {
+        return NULL;
+    }
+    unsigned index = ring->tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->user_data = user_data;
+    ring->sq_array[index] = index;
+    ring->tail++;
+    return sqe;
+}
+
+static inline int cs_uring_submit(cs_uring *ring, unsigned wait) {
+    __atomic_store_n(ring->sq_tail, ring->tail, __ATOMIC_RELEASE);
+    for (;;) {
+        unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+        unsigned pending = ring->tail - head;
+        if (pending == 0 && wait == 0) {
+            return 0;
+        }
+        long rc = syscall(__NR_io_uring_enter, ring->fd, pending, wait,
+                          wait ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+        if (rc >= 0) {
+            return 0;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if ((errno == EAGAIN || errno == EBUSY) && wait == 0) {
+            return 0;
+        }
+        return -errno;
+    }
+}
+
+typedef struct {
+    struct statx stx;
+    char *data;
+    size_t len;
+    size_t cap;
+    size_t want;
+    int fd;
+    int op;
+    int statted;
+    int regular;
+    int err;
+} cs_read_many_file;
+
+static inline int cs_read_many_uring(cs_uring *ring, char *const *paths,
+                                     size_t count, cs_buffer *results,
+                                     int *errors) {
+    cs_read_many_file *files =
+        (cs_read_many_file *)calloc(count, sizeof(cs_read_many_file));
+    size_t *queue = (size_t *)malloc(count * sizeof(size_t));
+    if (!files || !queue) {
+        free(files);
+        free(queue);
+        return -ENOMEM;
+    }
+
+    size_t queue_head = 0;
+    size_t queue_len = 0;
+    size_t next = 0;
+    size_t done = 0;
+    unsigned inflight = 0;
+    int rc = 0;
+    while (done < count && rc == 0) {
+        while (inflight < ring->entries && (queue_len > 0 || next < count)) {
+            size_t i = queue_len > 0 ? queue[queue_head] : next;
+            cs_read_many_file *file = &files[i];
+            int op = queue_len > 0 ? file->op : CS_READ_MANY_OPEN;
+            struct io_uring_sqe *sqe =
+                cs_uring_sqe(ring, (uint64_t)i << 3 | (uint64_t)op);
+            if (!sqe) {
+                break;
+            }
+            if (op == CS_READ_MANY_OPEN) {
+                file->fd = -1;
+                sqe->opcode = IORING_OP_OPENAT;
+                sqe->fd = AT_FDCWD;
+                sqe->addr = (uint64_t)(uintptr_t)paths[i];
+                sqe->open_flags = O_RDONLY | O_CLOEXEC;
+                next++;
+            } else {
+                sqe->fd = file->fd;
+                if (op == CS_READ_MANY_READ) {
+                    file->want = file->cap - 1 - file->len;
+                    sqe->opcode = IORING_OP_READ;
+                    sqe->addr = (uint64_t)(uintptr_t)(file->data + file->len);
+                    sqe->len = (unsigned)file->want;
+                    sqe->off = file->regular ? file->len : (uint64_t)-1;
+                } else if (op == CS_READ_MANY_STATX) {
+                    sqe->opcode = IORING_OP_STATX;
+                    sqe->addr = (uint64_t)(uintptr_t)"";
+                    sqe->len = STATX_TYPE | STATX_SIZE;
+                    sqe->off = (uint64_t)(uintptr_t)&file->stx;
+                    sqe->statx_flags = AT_EMPTY_PATH;
+                } else {
+                    sqe->opcode = IORING_OP_CLOSE;
+                }
+                queue_head = (queue_head + 1) % count;
+                queue_len--;
+            }
+            inflight++;
+        }
+
+        rc = cs_uring_submit(ring, inflight ? 1 : 0);
+        unsigned head = *ring->cq_head;
+        unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+            size_t i = (size_t)(cqe->user_data >> 3);
+            int op = (int)(cqe->user_data & 7);
+            int res = cqe->res;
+            cs_read_many_file *file = &files[i];
+            inflight--;
+
+            int next_op = CS_READ_MANY_READ;
+            if (op == CS_READ_MANY_CLOSE) {
+                file->fd = -1;
+                done++;
+                continue;
+            } else if (op == CS_READ_MANY_OPEN) {
+                if (res < 0) {
+                    file->err = res;
+                    done++;
+                    continue;
+                }
+                file->fd = res;
+                file->err = cs_read_many_grow(&file->data, &file->cap,
+                                              CS_READ_MANY_CHUNK);
+            } else if (op == CS_READ_MANY_STATX) {
+                file->statted = 1;
+                size_t need = file->cap * 2;
+                if (res >= 0 && S_ISREG(file->stx.stx_mode) &&
+                    file->stx.stx_size > 0) {
+                    file->regular = 1;
+                    need = (size_t)file->stx.stx_size + 2;
+                }
+                file->err = cs_read_many_grow(&file->data, &file->cap, need);
+            } else if (res < 0 && res != -EINTR && res != -EAGAIN) {
+                file->err = res;
+            } else if (res == 0 ||
+                       (file->regular && (size_t)res < file->want)) {
+                file->len += (size_t)(res > 0 ? res : 0);
+                next_op = CS_READ_MANY_CLOSE;
+            } else if (res > 0) {
+                file->len += (size_t)res;
+                if (file->len + 1 >= file->cap && !file->statted) {
+                    next_op = CS_READ_MANY_STATX;
+                } else if (file->len + 1 >= file->cap) {
+                    file->err = cs_read_many_grow(&file->data, &file->cap,
+                                                  file->cap * 2);
+                }
+            }
+            file->op = file->err ? CS_READ_MANY_CLOSE : next_op;
+            queue[(queue_head + queue_len++) % count] = i;
+        }
+        __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    while (rc != 0 && inflight > 0) {
+        if (cs_uring_submit(ring, 1) != 0) {
+            break;
+        }
+        unsigned head = *ring->cq_head;
+        unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+            cs_read_many_file *file = &files[cqe->user_data >> 3];
+            int op = (int)(cqe->user_data & 7);
+            inflight--;
+            if (op == CS_READ_MANY_OPEN && cqe->res >= 0) {
+                file->fd = cqe->res;
+            } else if (op == CS_READ_MANY_CLOSE) {
+                file->fd = -1;
+            }
+        }
+        __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        cs_read_many_file *file = &files[i];
+        if (rc != 0 && file->fd >= 0) {
+            close(file->fd);
+        }
+        if (rc == 0 && file->err == 0) {
+            file->data[file->len] = '\0';
+            results[i].data = file->data;
+            results[i].len = file->len;
+        } else if (inflight == 0) {
+            free(file->data);
+        }
+        errors[i] = rc != 0 ? rc : file->err;
+    }
+    if (inflight == 0) {
+        free(files);
+    }
+    free(queue);
+    return rc;
+}
+#endif
+
+static inline int cs_read_many(char *const *paths, size_t count,
+                               cs_buffer *results, int *errors) {
+    memset(results, 0, count * sizeof(cs_buffer));
+    int *owned = NULL;
+    if (!errors) {
+        owned = (int *)calloc(count ? count : 1, sizeof(int));
+        if (!owned) {
+            return -ENOMEM;
+        }
+        errors = owned;
+    }
+    if (count == 0) {
+        free(owned);
+        return 0;
+    }
+
+    int rc = -ENOSYS;
+#if defined(CS_HAVE_IO_URING)
+    cs_uring ring;
+    unsigned entries = CS_URING_ENTRIES;
+    while (entries > 8 && entries / 2 >= count * 2) {
+        entries /= 2;
+    }
+    if (cs_uring_init(&ring, entries) == 0) {
+        rc = cs_read_many_uring(&ring, paths, count, results, errors);
+        cs_uring_free(&ring);
+    }
+#endif
+    if (rc != 0 && rc != -ENOMEM) {
+        cs_read_many_job job = {paths, results, errors};
+        rc = cs_parallel_for(NULL, count, 16, cs_read_many_range, &job);
+    }
+    free(owned);
+    return rc;
+}
+
 #endif
@@ -0,0 +1,1013 @@
+import csv
+import io
+import json
+import random
+import re
+import shutil
+import subprocess
+import tempfile
+from fnmatch import fnmatchcase
+from pathlib import Path
+import unittest
+
+
+ROOT = Path(__file__).resolve().parents[1]
+
+
+@unittest.skipUnless(shutil.which("cc"), "cc is required")
+class CsHeaderTests(unittest.TestCase):
+    def _run_program(self, source: str, *args: str, stdin: str = "",
+                     cwd: Path | None = None,
+                     cflags: tuple[str, ...] = ()) -> str:
+        with tempfile.TemporaryDirectory() as tmp:
+            tmp_path = Path(tmp)
+            program = tmp_path / "prog.c"
+            output = tmp_path / "prog"
+            program.write_text(source, encoding="utf-8")
+            subprocess.run(
+                [
+                    "cc",
+                    "-O2",
+                    "-Wall",
+                    "-Wextra",
+                    "-Werror",
+                    "-std=c11",
+                    f"-I{ROOT}",
+                    *cflags,
+                    str(program),
+                    "-o",
+                    str(output),
+                    "-pthread",
+                ],
+                check=True,
+                cwd=ROOT,
+            )
+            result = subprocess.run(
+                [str(output), *args],
+                input=stdin,
+                capture_output=True,
+                text=True,
+                check=True,
+                cwd=cwd or tmp_path,
+            )
+            return result.stdout
+
+    def test_reader_splits_lines_from_pipe_and_file(self) -> None:
+        source = (
+            '#include "cs.h"\n'
+            "int main(int argc, char **argv) {\n"
+            "    cs_reader reader;\n"
+            "    if (cs_lines_open(&reader, argc > 1 ? argv[1] : NULL) != 0)\n"
+            "        return 1;\n"
+            "    cs_view line;\n"
+            "    while (cs_reader_next(&reader, &line) > 0)\n"
+            '        printf("[%.*s]\\n", (int)line.len, line.data);\n'
+            "    cs_reader_close(&reader);\n"
+            "    return 0;\n"
+            "}\n"
+        )
+        self.assertEqual(
+            self._run_program(source, stdin="a\n\nbc\nlast"),
+            "[a]\n[]\n[bc]\n[last]\n",
+        )
+
+        with tempfile.TemporaryDirectory() as tmp:
+            data = Path(tmp) / "big.txt"
+            lines = [f"line-{i}-" + "x" * (i % 700) for i in range(2000)]
+            lines.insert(1000, "y" * 600000)
+            data.write_text("\n".join(lines) + "\n", encoding="utf-8")
+            out = self._run_program(source, str(data))
+            self.assertEqual(out, "".join(f"[{line}]\n" for line in lines))
+
+    def test_header_compiles_after_system_headers(self) -> None:
+        source = (
+            "#include <stdio.h>\n"
+            "#include <sys/stat.h>\n"
+            '#include "cs.h"\n'
+            "int main(void) {\n"
+            "    cs_reader reader;\n"
+            "    if (cs_lines_open(&reader, NULL) != 0)\n"
+            "        return 1;\n"
+            "    cs_view line;\n"
+            "    while (cs_reader_next(&reader, &line) > 0)\n"
+            '        printf("%zu\\n", line.len);\n'
+            "    cs_reader_close(&reader);\n"
+            "    return 0;\n"
+            "}\n"
+        )
+        self.assertEqual(self._run_program(source, stdin="ab\ncde\n"), "2\n3\n")
+
+    def test_map_file_handles_regular_files_pipes_and_proc(self) -> None:
+        source = (
+            '#include "cs.h"\n'
+            "int main(int argc, char **argv) {\n"
+            "    cs_file_view view;\n"
+            "    if (cs_map_file(argc > 1 ? argv[1] : NULL, &view, 0) != 0)\n"
+            "        return 1;\n"
+            "    size_t lines = 0;\n"
+            "    for (size_t i = 0; i < view.len; i++)\n"
+            "        lines += view.data[i] == '\\n';\n"
+            '    printf("%d %zu %zu\\n", view.mapped, view.len, lines);\n'
+            "    cs_unmap_file(&view);\n"
+            "    return 0;\n"
+            "}\n"
+        )
+        self.assertEqual(self._run_program(source, stdin="a\nb\nc\n"), "0 6 3\n")
+
+        with tempfile.TemporaryDirectory() as tmp:
+            data = Path(tmp) / "data.txt"
+            data.write_text("row\n" * 100000, encoding="utf-8")
+            self.assertEqual(self._run_program(source, str(data)), "1 400000 100000\n")
+
+        mapped, length, _ = self._run_program(source, "/proc/self/status").split()
+        self.assertEqual(mapped, "0")
+        self.assertGreater(int(length), 0)
+
+    def test_arena_variants_share_one_region_across_resets(self) -> None:
+        source = (
+            '#include "cs.h"\n'
+            "static int cmp(const void *a, const void *b) {\n"
+            "    return strcmp(*(char *const *)a, *(char *const *)b);\n"
+            "}\n"
+            "int main(void) {\n"
+            "    cs_arena arena;\n"
+            "    cs_arena_init(&arena, 1024);\n"
+            "    for (int round = 0; round < 3; round++) {\n"
+            "        char **entries = NULL;\n"
+            "        size_t count = 0;\n"
+            '        if (cs_list_dir_arena(&arena, "data", &entries, &count))\n'
+            "            return 1;\n"
+            "        qsort(entries, count, sizeof(char *), cmp);\n"
+            "        size_t bytes = 0;\n"
+            "        char path[256];\n"
+            "        for (size_t i = 0; i < count; i++) {\n"
+            '            snprintf(path, sizeof(path), "data/%s", entries[i]);\n'
+            "            bytes += cs_read_file_arena(&arena, path).len;\n"
+            "        }\n"
+            "        cs_arena_mark mark = cs_arena_get_mark(&arena);\n"
+            '        cs_buffer out = cs_run_cmd_capture_arena(&arena, "echo hi");\n'
+            '        printf("%zu %s %zu %s", count, entries[0], bytes,\n'
+            '               out.data ? out.data : "");\n'
+            "        cs_arena_reset_to(&arena, mark);\n"
+            "        cs_arena_reset(&arena);\n"
+            "    }\n"
+            "    cs_arena_free(&arena);\n"
+            "    return 0;\n"
+            "}\n"
+        )
+        with tempfile.TemporaryDirectory() as tmp:
+            data = Path(tmp) / "data"
+            data.mkdir()
+            for i in range(300):
+                (data / f"f{i:03d}").write_text("z" * i, encoding="utf-8")
+            out = self._run_program(source, cwd=Path(tmp))
+            self.assertEqual(out, "300 f000 44850 hi\n" * 3)
+
+    def test_run_many_captures_streams_and_exit_status(self) -> None:
+        source = (
+            '#include "cs.h"\n'
+            "int main(void) {\n"
+            '    char *ok[] = {"sh", "-c", "echo out; echo err >&2", NULL};\n'
+            '    char *fail[] = {"sh", "-c", "printf partial; exit 3", NULL};\n'
+            '    char *big[] = {"sh", "-c", "head -c 300000 /dev/zero", NULL};\n'
+            '    char *missing[] = {"cs-no-such-command", NULL};\n'
+            "    char **cmds[] = {ok, fail, big, missing, ok, fail};\n"
+            "    cs_cmd_result results[6];\n"
+            "    if (cs_run_many(cmds, 6, 2, results) != 0)\n"
+            "        return 1;\n"
+            "    for (int i = 0; i < 6; i++) {\n"
+            '        printf("%d %zu %zu\\n", results[i].status,\n'
+            "               results[i].out.len, results[i].err.len);\n"
+            "        cs_cmd_result_free(&results[i]);\n"
+            "    }\n"
+            "    cs_cmd_result single;\n"
+            "    int rc = cs_run_capture(ok, &single);\n"
+            '    printf("%d %s%s", rc, single.out.data, single.err.data);\n'
+            "    cs_cmd_result_free(&single);\n"
+            "    return 0;\n"
+            "}\n"
+        )
+        self.assertEqual(
+            self._run_program(source),
+            "0 4 4\n3 7 0\n0 300000 0\n-2 0 0\n0 4 4\n3 7 0\n0 out\nerr\n",
+        )
+
+    def test_walk_visits_tree_from_several_threads(self) -> None:
+        source = (
+            '#include "cs.h"\n'
+            "static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;\n"
+            "static long long files, dirs, bytes;\n"
+            "static int on_batch(const cs_walk_entry *e, size_t n, void *ctx) {\n"
+            "    (void)ctx;\n"
+            "    pthread_mutex_lock(&lock);\n"
+            "    for (size_t i = 0; i < n; i++) {\n"
+            "        if (e[i].type == CS_WALK_DIR) dirs++;\n"
+            "        if (e[i].type == CS_WALK_FILE) { files++; bytes += e[i].size; }\n"
+            "        if (strcmp(e[i].path + e[i].path_len - strlen(e[i].name),\n"
+            "                   e[i].name) != 0) files = -1000000;\n"
+            "    }\n"
+            "    pthread_mutex_unlock(&lock);\n"
+            "    return 0;\n"
+            "}\n"
+            "static int stop_early(const cs_walk_entry *e, size_t n, void *ctx) {\n"
+            "    (void)e; (void)n; (void)ctx;\n"
+            "    return 7;\n"
+            "}\n"
+            "int main(void) {\n"
+            "    cs_walk_opts opts = {4, CS_WALK_STAT, 0, 3};\n"
+            '    int rc = cs_walk("tree/", &opts, on_batch, NULL);\n'
+            '    printf("%d %lld %lld %lld\\n", rc, files, dirs, bytes);\n'
+            "    cs_walk_opts shallow = {2, 0, 1, 0};\n"
+            "    files = dirs = bytes = 0;\n"
+            '    rc = cs_walk("tree", &shallow, on_batch, NULL);\n'
+            '    printf("%d %lld %lld\\n", rc, files, dirs);\n'
+            '    printf("%d ", cs_walk("tree", NULL, stop_early, NULL));\n'
+            '    printf("%d\\n", cs_walk("missing", NULL, stop_early, NULL));\n'
+            "    return 0;\n"
+            "}\n"
+        )
+        with tempfile.TemporaryDirectory() as tmp:
+            tree = Path(tmp) / "tree"
+            total = 0
+            for a in range(6):
+                for b in range(5):
+                    leaf = tree / f"a{a}" / f"b{b}"
+                    leaf.mkdir(parents=True)
+                    for c in range(7):
+                        (leaf / f"f{c}").write_text("q" * c, encoding="utf-8")
+                        total += c
+            (tree / "top.txt").write_text("top", encoding="utf-8")
+            out = self._run_program(source, cwd=Path(tmp))
+            self.assertEqual(
+                out, f"0 211 36 {total + 3}\n0 1 6\n7 -2\n"
+            )
+
+    def test_walk_opens_children_from_parent_and_reports_errors(self) -> None:
+        source = (
+            '#include "cs.h"\n'
+            "static long long seen;\n"
+            "static int move_away(const cs_walk_entry *e, size_t n, void *ctx) {\n"
+            "    (void)e; (void)ctx;\n"
+            "    seen += (long long)n;\n"
+            '    return seen == 1 && chdir("/") != 0;\n'
+            "}\n"
+            "static int remove_gone(const cs_walk_entry *e, size_t n, void *ctx) {\n"
+            "    seen += (long long)n;\n"
+            '    return strcmp(e[0].name, "gone") == 0 && rmdir(ctx) != 0;\n'
+            "}\n"
+            "int main(int argc, char **argv) {\n"
+            "    (void)argc;\n"
+            "    cs_walk_opts opts = {1, 0, 0, 1};\n"
+            '    int rc = cs_walk("tree", &opts, move_away, NULL);\n'
+            '    printf("%d %lld\\n", rc, seen);\n'
+            "    seen = 0;\n"
+            "    rc = cs_walk(argv[1], &opts, remove_gone, argv[2]);\n"
+            '    printf("%d %lld\\n", rc, seen);\n'
+            "    return 0;\n"
+            "}\n"
+        )
+        with tempfile.TemporaryDirectory() as tmp:
+            tree = Path(tmp) / "tree"
+            (tree / "a" / "b" / "c").mkdir(parents=True)
+            (tree / "a" / "b" / "c" / "f").write_text("x", encoding="utf-8")
+            (tree / "gone").mkdir()
+            out = self._run_program(source, str(tree), str(tree / "gone"), cwd=Path(tmp))
+            self.assertEqual(out, "0 5\n-2 5\n")
+
+    def test_parallel_for_covers_ranges_and_dir_entries(self) -> None:
+        source = (
+            '#include "cs.h"\n'
+            "static cs_pool *pool;\n"
+            "static atomic_ullong total;\n"
+            "static atomic_size_t seen[300];\n"
+            "static void sum(size_t begin, size_t end, int worker, void *ctx) {\n"
+            "    (void)ctx;\n"
+            "    unsigned long long *acc = cs_pool_scratch(pool, worker, 64);\n"
+            "    *acc = 0;\n"
+            "    for (size_t i = begin; i < end; i++) *acc += i;\n"
+            "    atomic_fetch_add(&total, *acc);\n"
+            "}\n"
+            "static void nested(size_t begin, size_t end, int worker, void *ctx) {\n"
+            "    (void)worker; (void)ctx;\n"
+            "    for (size_t i = begin; i < end; i++)\n"
+            "        cs_parallel_for(pool, i, 0, sum, NULL);\n"
+            "}\n"
+            "static void visit(const char *entry, size_t index, int worker,\n"
+            "                  void *ctx) {\n"
+            "    (void)worker; (void)ctx;\n"
+            "    atomic_fetch_add(&seen[index], strlen(entry));\n"
+            "}\n"
+            "int main(void) {\n"
+            "    pool = cs_pool_create(4);\n"
+            "    for (int round = 0; round < 10; round++)\n"
+            "        cs_parallel_for(pool, 1000003, 0, sum, NULL);\n"
+            "    cs_parallel_for(pool, 100, 3, nested, NULL);\n"
+            "    char **entries = NULL;\n"
+            "    size_t count = 0;\n"
+            '    if (cs_list_dir("data", &entries, &count) != 0) return 1;\n'
+            "    cs_parallel_for_entries(NULL, entries, count, visit, NULL);\n"
+            "    size_t chars = 0;\n"
+            "    for (size_t i = 0; i < count; i++) {\n"
+            "        chars += atomic_load(&seen[i]);\n"
+            "        free(entries[i]);\n"
+            "    }\n"
+            "    free(entries);\n"
+            '    printf("%d %llu %zu %zu\\n", cs_pool_threads(pool),\n'
+            "           (unsigned long long)atomic_load(&total), count, chars);\n"
+            "    cs_pool_destroy(pool);\n"
+            "    return 0;\n"
+            "}\n"
+        )
+        with tempfile.TemporaryDirectory() as tmp:
+            data = Path(tmp) / "data"
+            data.mkdir()
+            for i in range(300):
+                (data / f"entry-{i:03d}").write_text("", encoding="utf-8")
+            out = self._run_program(source, cwd=Path(tmp))
+            expected_total = 10 * (1000003 * 1000002 // 2)
+            expected_total += sum(i * (i - 1) // 2 for i in range(100))
+            self.assertEqual(out, f"4 {expected_total} 300 2700\n")
+
+    def test_map_counts_keys_and_intern_deduplicates(self) -> None:
+        source = (
+            '#include "cs.h"\n'
+            "int main(void) {\n"
+            "    cs_map map;\n"
+            "    cs_map_init(&map, 0);\n"
+            "    char key[32];\n"
+            "    for (int i = 0; i < 100000; i++) {\n"
+            '        int n = snprintf(key, sizeof(key), "k%d", i % 1000);\n'
+            "        (*cs_map_upsert(&map, key, (size_t)n))++;\n"
+            "    }\n"
+            "    size_t iter = 0, slots = 0;\n"
+            "    uint64_t sum = 0;\n"
+            "    cs_map_slot *slot;\n"
+            "    while ((slot = cs_map_next(&map, &iter)) != NULL) {\n"
+            "        slots++;\n"
+            "        sum += slot->value;\n"
+            "    }\n"
+            '    uint64_t *k7 = cs_map_get(&map, "k7", 2);\n'
+            '    uint64_t *missing = cs_map_get(&map, "k7x", 3);\n'
+            '    printf("%zu %zu %llu %llu %d\\n", map.count, slots,\n'
+            "           (unsigned long long)sum, (unsigned long long)*k7,\n"
+            "           missing == NULL);\n"
+            "    cs_map_free(&map);\n"
+            "    cs_intern intern;\n"
+            "    cs_intern_init(&intern, 0);\n"
+            '    const char *a = cs_intern_str(&intern, "alpha-beta", 5);\n'
+            '    const char *b = cs_intern_str(&intern, "alpha", 5);\n'
+            '    const char *c = cs_intern_str(&intern, "beta", 4);\n'
+            '    printf("%s %d %d\\n", a, a == b, a == c);\n'
+            "    cs_intern_free(&intern);\n"
+            '    printf("%d\\n", cs_hash("abc", 3) == cs_hash("abc", 3) &&\n'
+            '                     cs_hash("abc", 3) != cs_hash("abd", 3));\n'
+            "    return 0;\n"
+            "}\n"
+        )
+        self.assertEqual(
+            self._run_program(source), "1000 1000 100000 100 1\nalpha 1 0\n1\n"
+        )
+
+    def test_out_formats_numbers_like_printf(self) -> None:
+        source = (
+            '#include "cs.h"\n'
+            "#include <stdint.h>\n"
+            "int main(void) {\n"
+            "    const int64_t ints[] = {0, 7, -7, 10, 99, 100, 123456789,\n"
+            "                            INT64_MIN, INT64_MAX};\n"
+            "    const double floats[] = {0.0, 1.5, -2.25, 3.14159, 0.0005,\n"
+            "                             -0.0004, -0.0, 999.9996, 1e20};\n"
+            "    cs_out out;\n"
+            "    cs_out_init(&out, STDOUT_FILENO);\n"
+            "    char expect[512];\n"
+            "    for (size_t i = 0; i < sizeof(ints) / sizeof(ints[0]); i++) {\n"
+            "        cs_out_i64(&out, ints[i]);\n"
+            "        cs_out_char(&out, ' ');\n"
+            '        snprintf(expect, sizeof(expect), "%lld\\n", (long long)ints[i]);\n'
+            "        cs_out_str(&out, expect);\n"
+            "    }\n"
+            "    cs_out_u64(&out, UINT64_MAX);\n"
+            "    cs_out_char(&out, '\\n');\n"
+            "    for (size_t i = 0; i < sizeof(floats) / sizeof(floats[0]); i++) {\n"
+            "        cs_out_f64(&out, floats[i], 3);\n"
+            "        cs_out_char(&out, ' ');\n"
+            '        snprintf(expect, sizeof(expect), "%.3f\\n", floats[i]);\n'
+            "        cs_out_str(&out, expect);\n"
+            "    }\n"
+            "    static char big[200000];\n"
+            "    memset(big, 'b', sizeof(big));\n"
+            "    cs_out_write(&out, big, sizeof(big));\n"
+            "    cs_out_char(&out, '\\n');\n"
+            "    cs_out_f64(&out, 1e308, 60);\n"
+            "    cs_out_char(&out, '\\n');\n"
+            "    if (cs_out_close(&out) != 0) return 1;\n"
+            '    if (cs_write_buffer("bin.dat", "a\\0b\\0", 4) != 0) return 1;\n'
+            '    cs_buffer back = cs_read_file("bin.dat");\n'
+            "    fprintf(stderr, \"%zu\", back.len);\n"
+            "    free(back.data);\n"
+            "    return back.len == 4 ? 0 : 1;\n"
+            "}\n"
+        )
+        lines = self._run_program(source).split("\n")
+        numeric = lines[:9] + lines[10:19]
+        for line in numeric:
+            ours, theirs = line.split(" ")
+            self.assertEqual(ours, theirs)
+        self.assertEqual(lines[9], "18446744073709551615")
+        self.assertEqual(lines[19], "b" * 200000)
+        self.assertEqual(lines[20], f"{1e308:.60f}")
+
+    def test_format_f64_matches_printf_on_random_values_and_ties(self) -> None:
+        source = (
+            '#include "cs.h"\n'
+            "static uint64_t state = 33;\n"
+            "static uint64_t next(void) {\n"
+            "    state ^= state << 13;\n"
+            "    state ^= state >> 7;\n"
+            "    state ^= state << 17;\n"
+            "    return state;\n"
+            "}\n"
+            "static int check(double value, int decimals) {\n"
+            "    char ours[64], theirs[64];\n"
+            "    cs_format_f64(ours, sizeof(ours), value, decimals);\n"
+            '    snprintf(theirs, sizeof(theirs), "%.*f", decimals, value);\n'
+            "    if (strcmp(ours, theirs) == 0) return 0;\n"
+            '    printf("%.17g/%d %s %s\\n", value, decimals, ours, theirs);\n'
+            "    return 1;\n"
+            "}\n"
+            "int main(void) {\n"
+            "    int bad = check(84.5, 0) + check(317.125, 2) + check(-0.0, 2) +\n"
+            "              check(367.03125, 4) + check(-20583963799562.289, 6);\n"
+            "    for (int i = 0; i < 200000; i++) {\n"
+            "        int decimals = (int)(next() % 10);\n"
+            "        uint64_t bits = next();\n"
+            "        double value;\n"
+            "        if (i % 3 == 0) {\n"
+            "            int den = (int)(next() % 12);\n"
+            "            value = (double)(bits % 100000000) / (double)(1 << den);\n"
+            "        } else if (i % 3 == 1) {\n"
+            "            value = (double)(bits >> 11) / 9007199254740992.0 *\n"
+            "                    (double)(1ull << (next() % 60));\n"
+            "        } else {\n"
+            "            bits = (bits & ~(0x7ffull << 52)) |\n"
+            "                   ((uint64_t)(1023 - 40 + next() % 90) << 52);\n"
+            "            memcpy(&value, &bits, sizeof(value));\n"
+            "        }\n"
+            "        if (next() & 1) value = -value;\n"
+            "        bad += check(value, decimals);\n"
+            "    }\n"
+            '    printf("bad %d\\n", bad);\n'
+            "    return 0;\n"
+            "}\n"
+        )
+        self.assertEqual(self._run_program(source), "bad 0\n")
+
+    def test_fields_match_csv_module_for_every_scanner(self) -> None:
+        source = (
+            '#include "cs.h"\n'
+            "int main(int argc, char **argv) {\n"
+            "    (void)argc;\n"
+            "    cs_buffer buf = cs_read_file(argv[1]);\n"
+            "    cs_fields parser;\n"
+            "    cs_fields_init(&parser, buf.data, buf.len, argv[2][0]);\n"
+            "    cs_field fields[64];\n"
+            "    size_t count = 0;\n"
+            "    char *text = malloc(buf.len + 1);\n"
+            "    while (cs_fields_row(&parser, fields, 64, &count) > 0) {\n"
+            "        for (size_t i = 0; i < count; i++) {\n"
+            "            size_t n = cs_field_unescape(&fields[i], '\"', text);\n"
+            '            if (i) putchar(0x1f);\n'
+            "            for (size_t c = 0; c < n; c++)\n"
+            "                putchar(text[c] == '\\r' ? 0x1d : text[c]);\n"
+            "        }\n"
+            '        printf("\\x1e");\n'
+            "    }\n"
+            "    free(text);\n"
+            "    free(buf.data);\n"
+            "    return 0;\n"
+            "}\n"
+        )
+        rng = random.Random(4180)
+        alphabet = ["a", "b", " ", ",", "\t", '"', "\n", "\r\n", "xyz"]
+        rows = []
+        for _ in range(400):
+            row = ["h" + "".join(rng.choice(alphabet) for _ in range(rng.randrange(4)))]
+            for _ in range(rng.randrange(12)):
+                row.append("".join(rng.choice(alphabet) for _ in range(rng.randrange(40))))
+            rows.append(row)
+
+        for delim in [",", "\t"]:
+            buffer = io.StringIO()
+            csv.writer(buffer, delimiter=delim, lineterminator="\r\n").writerows(rows)
+            text = buffer.getvalue() + "tail" + delim + delim + '"open'
+            expected = [
+                [field.replace("\r", "\x1d") for field in row]
+                for row in csv.reader(io.StringIO(text, newline=""), delimiter=delim)
+            ]
+            with tempfile.TemporaryDirectory() as tmp:
+                data = Path(tmp) / "data.csv"
+                data.write_bytes(text.encode("utf-8"))
+                for flags in [(), ("-U__SSE2__", "-U__AVX2__"), ("-mavx2",)]:
+                    out = self._run_program(source, str(data), delim, cflags=flags)
+                    parsed = [r.split("\x1f") for r in out.split("\x1e")[:-1]]
+                    self.assertEqual(parsed, expected, flags)
+
+    def test_parse_numbers_from_unterminated_views(self) -> None:
+        source = (
+            '#include "cs.h"\n'
+            "int main(void) {\n"
+            "    cs_reader reader;\n"
+            "    cs_lines_open(&reader, NULL);\n"
+            "    cs_view line;\n"
+            "    while (cs_reader_next(&reader, &line) > 0) {\n"
+            "        int64_t i = 0;\n"
+            "        uint64_t u = 0;\n"
+            "        double d = 0;\n"
+            "        errno = 0;\n"
+            "        size_t ni = cs_parse_i64(line.data, line.len, &i);\n"
+            "        int ei = errno == ERANGE;\n"
+            "        errno = 0;\n"
+            "        size_t nu = cs_parse_u64(line.data, line.len, &u);\n"
+            "        int eu = errno == ERANGE;\n"
+            "        size_t nd = cs_parse_f64(line.data, line.len, &d);\n"
+            '        printf("%zu %lld %d %zu %llu %d %zu %.17g\\n", ni,\n'
+            "               (long long)i, ei, nu, (unsigned long long)u, eu,\n"
+            "               nd, d);\n"
+            "    }\n"
+            "    cs_reader_close(&reader);\n"
+            "    return 0;\n"
+            "}\n"
+        )
+        rng = random.Random(35)
+        inputs = [
+            "0", "-0", "+12", "123abc", "18446744073709551615",
+            "18446744073709551616", "9223372036854775807",
+            "-9223372036854775808", "-9223372036854775809", "0.1", ".5", "5.",
+            "1e22", "1e23", "123.456e-5", "2.2250738585072014e-308",
+            "1.7976931348623157e308", "3.14159265358979323846264338327950288",
+            "00000000000000000000000042", "1e", "x", "-",
+        ]
+        for _ in range(400):
+            digits = "".join(rng.choice("0123456789") for _ in range(rng.randrange(1, 22)))
+            point = rng.randrange(len(digits) + 1)
+            text = digits[:point] + "." + digits[point:]
+            if rng.random() < 0.5:
+                text += f"e{rng.randrange(-330, 310)}"
+            inputs.append(rng.choice(["", "-"]) + text)
+            inputs.append(rng.choice(["", "-"]) + digits)
+
+        out = self._run_program(source, stdin="\n".join(inputs) + "\n")
+        for text, line in zip(inputs, out.splitlines(), strict=True):
+            ni, i, ei, nu, u, eu, nd, d = line.split(" ")
+            int_match = re.match(r"[+-]?[0-9]+", text)
+            if int_match:
+                value = int(int_match.group(0))
+                self.assertEqual(int(ni), len(int_match.group(0)), text)
+                clamped = max(-(2**63), min(2**63 - 1, value))
+                self.assertEqual((int(i), ei == "1"), (clamped, clamped != value), text)
+            else:
+                self.assertEqual(ni, "0", text)
+            uint_match = re.match(r"[+]?[0-9]+", text)
+            if uint_match:
+                value = int(uint_match.group(0))
+                self.assertEqual(int(nu), len(uint_match.group(0)), text)
+                self.assertEqual((int(u), eu == "1"), (min(value, 2**64 - 1), value >= 2**64), text)
+            else:
+                self.assertEqual(nu, "0", text)
+            float_match = re.match(r"[+-]?([0-9]+\.?[0-9]*|\.[0-9]+)([eE][+-]?[0-9]+)?", text)
+            if float_match:
+                self.assertEqual(int(nd), len(float_match.group(0)), text)
+                self.assertEqual(float(d), float(float_match.group(0)), text)
+            else:
+                self.assertEqual(nd, "0", text)
+
+    def test_json_tokens_and_paths_match_python(self) -> None:
+        source = (
+            '#include "cs.h"\n'
+            "int main(int argc, char **argv) {\n"
+            "    cs_file_view view;\n"
+            "    if (cs_map_file(NULL, &view, 0) != 0) return 1;\n"
+            "    char *text = malloc(view.len + 1);\n"
+            "    if (argc > 1) {\n"
+            "        for (int i = 1; i < argc; i++) {\n"
+            "            cs_json_token token;\n"
+            "            int rc = cs_json_find(view.data, view.len, argv[i], &token);\n"
+            '            if (rc != 0) { printf("%d\\n", rc); continue; }\n'
+            "            size_t n = cs_json_unescape(&token, text);\n"
+            '            printf("%d %.*s\\n", token.type, (int)n, text);\n'
+            "        }\n"
+            "        return 0;\n"
+            "    }\n"
+            "    cs_json json;\n"
+            "    cs_json_init(&json, view.data, view.len);\n"
+            "    cs_json_token token;\n"
+            "    int type;\n"
+            "    while ((type = cs_json_next(&json, &token)) > 0) {\n"
+            '        printf("%d %d ", type, token.depth);\n'
+            "        size_t n = cs_json_unescape(&token, text);\n"
+            "        if (type == CS_JSON_KEY || type == CS_JSON_STRING)\n"
+            '            for (size_t i = 0; i < n; i++) printf("%02x", (unsigned char)text[i]);\n'
+            "        else if (type == CS_JSON_NUMBER)\n"
+            '            printf("%.*s", (int)token.len, token.data);\n'
+            '        printf("\\n");\n'
+            "    }\n"
+            '    printf("end %d\\n", type);\n'
+            "    cs_unmap_file(&view);\n"
+            "    free(text);\n"
+            "    return 0;\n"
+            "}\n"
+        )
+
+        def expected_tokens(value, depth, out):
+            if isinstance(value, dict):
+                out.append(f"1 {depth} ")
+                for key, item in value.items():
+                    out.append(f"5 {depth + 1} {key.encode().hex()}")
+                    expected_tokens(item, depth + 1, out)
+                out.append(f"2 {depth} ")
+            elif isinstance(value, list):
+                out.append(f"3 {depth} ")
+                for item in value:
+                    expected_tokens(item, depth + 1, out)
+                out.append(f"4 {depth} ")
+            elif isinstance(value, str):
+                out.append(f"6 {depth} {value.encode().hex()}")
+            elif value is True:
+                out.append(f"8 {depth} ")
+            elif value is False:
+                out.append(f"9 {depth} ")
+            elif value is None:
+                out.append(f"10 {depth} ")
+            else:
+                out.append(f"7 {depth} {json.dumps(value)}")
+
+        rng = random.Random(36)
+
+        def random_value(level):
+            kind = rng.randrange(7 if level < 4 else 5)
+            if kind == 0:
+                return rng.randrange(-10**12, 10**12)
+            if kind == 1:
+                return "".join(rng.choice('ab"\\\n\té😀/ ') for _ in range(rng.randrange(40)))
+            if kind == 2:
+                return rng.choice([True, False, None])
+            if kind == 3:
+                return rng.randrange(10**6) / 64
+            if kind == 4:
+                return "plain"
+            if kind == 5:
+                return [random_value(level + 1) for _ in range(rng.randrange(5))]
+            return {f"k{i}": random_value(level + 1) for i in range(rng.randrange(5))}
+
+        records = [{"id": i, "body": random_value(0)} for i in range(150)]
+        lines = [
+            json.dumps(r, ensure_ascii=rng.random() < 0.5, indent=rng.choice([None, 2, 40]))
+            for r in records
+        ]
+        expected = []
+        for record in records:
+            expected_tokens(record, 0, expected)
+        out = self._run_program(source, stdin="\n".join(lines) + "\n")
+        self.assertEqual(out.splitlines(), expected + ["end 0"])
+
+        doc = json.dumps({"tag_name": "v0.1.3", "assets": [{"name": "a"}, {"name": "b\\u00e9"}],
+                          "nested": {"deep": {"x": [1, 2, {"y": True}]}}})
+        out = self._run_program(
+            source, "tag_name", "assets.1.name", "nested.deep.x.2.y", "nested.deep",
+            "assets.5", "missing", stdin=doc,
+        )
+        self.assertEqual(
+            out.splitlines(),
+            ["6 v0.1.3", "6 b\\u00e9", "8 true", '1 {"x": [1, 2, {"y": true}]}', "-2", "-2"],
+        )
+        self.assertEqual(
+            self._run_program(source, stdin='{"a": [1, 2}'),
+            "1 0 \n5 1 61\n3 1 \n7 2 1\n7 2 2\nend -1\n",
+        )
+        self.assertEqual(
+            self._run_program(source, stdin="[-0.5e+3,0 ,1E2,\ttrue]"),
+            "3 0 \n7 1 -0.5e+3\n7 1 0\n7 1 1E2\n8 1 \n4 0 \nend 0\n",
+        )
+        last_type = (
+            '#include "cs.h"\n'
+            "int main(int argc, char **argv) {\n"
+            "    for (int i = 1; i < argc; i++) {\n"
+            "        cs_json json;\n"
+            "        cs_json_token token;\n"
+            "        cs_json_init(&json, argv[i], strlen(argv[i]));\n"
+            "        int type;\n"
+            "        while ((type = cs_json_next(&json, &token)) > 0) {}\n"
+            '        printf("%d\\n", type);\n'
+            "    }\n"
+            "    return 0;\n"
+            "}\n"
+        )
+        bad = ["truefalse", "nullx", "[1.]", "01", "-", "[1e]", "[1-2]", "[.5]", "[--1]",
+               '{"a":tru}']
+        self.assertEqual(
+            self._run_program(last_type, *bad, "[false, 1e-2]"),
+            "-1\n" * len(bad) + "0\n",
+        )
+
+    def test_copy_atomic_write_and_pipeline_keep_bytes(self) -> None:
+        source = (
+            '#include "cs.h"\n'
+            "int main(int argc, char **argv) {\n"
+            "    (void)argc;\n"
+            '    printf("copy %d\\n", cs_copy_file(argv[1], "copy.bin"));\n'
+            '    printf("stdin %d\\n", cs_copy_file("/dev/stdin", "stdin.txt"));\n'
+            '    int rc = cs_copy_file("missing", "never.bin");\n'
+            '    printf("missing %d\\n", rc == -ENOENT);\n'
+            '    rc = cs_copy_file("copy.bin", "./copy.bin");\n'
+            '    printf("same %d\\n", rc == -EINVAL);\n'
+            "    umask(027);\n"
+            '    rc = cs_write_file_atomic("atomic.txt", "first\\n", 6);\n'
+            '    printf("atomic %d\\n", rc);\n'
+            '    rc = cs_write_file_atomic("atomic.txt", "second\\n", 7);\n'
+            '    printf("atomic %d\\n", rc);\n'
+            '    char *sort_argv[] = {"sort", NULL};\n'
+            '    char *uniq_argv[] = {"uniq", "-c", NULL};\n'
+            '    char *tr_argv[] = {"tr", "-s", " ", NULL};\n'
+            "    char **const stages[] = {sort_argv, uniq_argv, tr_argv};\n"
+            '    int in_fd = open("stdin.txt", O_RDONLY);\n'
+            '    int out_fd = open("counts.txt", O_WRONLY | O_CREAT | O_TRUNC, 0644);\n'
+            "    int statuses[3] = {-1, -1, -1};\n"
+            "    rc = cs_pipeline(stages, 3, in_fd, out_fd, statuses);\n"
+            "    close(in_fd);\n"
+            "    close(out_fd);\n"
+            '    printf("pipeline %d %d %d %d\\n", rc, statuses[0], statuses[1],\n'
+            "           statuses[2]);\n"
+            '    char *false_argv[] = {"false", NULL};\n'
+            '    char *bogus_argv[] = {"cs-no-such-command", NULL};\n'
+            "    char **const failing[] = {false_argv, bogus_argv};\n"
+            "    statuses[0] = statuses[1] = 0;\n"
+            "    rc = cs_pipeline(failing, 2, -1, -1, statuses);\n"
+            '    printf("failing %d %d %d\\n", rc == statuses[1], statuses[0],\n'
+            "           statuses[1] < 0);\n"
+            "    return 0;\n"
+            "}\n"
+        )
+        with tempfile.TemporaryDirectory() as tmp:
+            tmp_path = Path(tmp)
+            rng = random.Random(37)
+            blob = rng.randbytes(3 << 20)
+            (tmp_path / "src.bin").write_bytes(blob)
+            (tmp_path / "src.bin").chmod(0o640)
+            words = "\n".join(rng.choice(["b", "a", "c"]) for _ in range(5000)) + "\n"
+            out = self._run_program(source, str(tmp_path / "src.bin"), stdin=words, cwd=tmp)
+            self.assertEqual(
+                out.splitlines(),
+                ["copy 0", "stdin 0", "missing 1", "same 1", "atomic 0", "atomic 0",
+                 "pipeline 0 0 0 0", "failing 1 1 1"],
+            )
+            self.assertEqual((tmp_path / "copy.bin").read_bytes(), blob)
+            self.assertEqual((tmp_path / "copy.bin").stat().st_mode & 0o777, 0o640)
+            self.assertEqual((tmp_path / "stdin.txt").read_text(), words)
+            self.assertEqual((tmp_path / "atomic.txt").read_text(), "second\n")
+            self.assertEqual((tmp_path / "atomic.txt").stat().st_mode & 0o777, 0o640)
+            hidden = [p.name for p in tmp_path.iterdir() if p.name.startswith(".")]
+            self.assertEqual(hidden, [])
+            lines = words.split()
+            expected = "".join(f" {lines.count(w)} {w}\n" for w in sorted(set(lines)))
+            self.assertEqual((tmp_path / "counts.txt").read_text(), expected)
+
+    def test_read_many_matches_read_file_on_both_backends(self) -> None:
+        source = (
+            '#include "cs.h"\n'
+            "int main(int argc, char **argv) {\n"
+            "    size_t count = (size_t)argc - 1;\n"
+            "    cs_buffer *results = calloc(count, sizeof(cs_buffer));\n"
+            "    int *errors = calloc(count, sizeof(int));\n"
+            '    printf("rc %d\\n", cs_read_many(argv + 1, count, results, errors));\n'
+            "    for (size_t i = 0; i < count; i++) {\n"
+            '        const char *data = results[i].data ? results[i].data : "";\n'
+            "        int terminated = !results[i].data || data[results[i].len] == 0;\n"
+            '        printf("%d %zu %016llx %d\\n", errors[i], results[i].len,\n'
+            "               (unsigned long long)cs_hash(data, results[i].len),\n"
+            "               terminated);\n"
+            "        free(results[i].data);\n"
+            "    }\n"
+            "    free(results);\n"
+            "    free(errors);\n"
+            "    return 0;\n"
+            "}\n"
+        )
+        with tempfile.TemporaryDirectory() as tmp:
+            tmp_path = Path(tmp)
+            rng = random.Random(38)
+            paths = []
+            sizes = [0, 1, 4095, 4096, 4097, 100000, 1 << 20]
+            sizes += [rng.randrange(200) for _ in range(600)]
+            for i, size in enumerate(sizes):
+                path = tmp_path / f"f{i}"
+                path.write_bytes(rng.randbytes(size))
+                paths.append(str(path))
+            paths += [str(tmp_path / "missing"), tmp, "/dev/null"]
+            outputs = [
+                self._run_program(source, *paths, cflags=cflags)
+                for cflags in ((), ("-DCS_NO_IO_URING",))
+            ]
+            self.assertEqual(outputs[0], outputs[1])
+            read_file = (
+                '#include "cs.h"\n'
+                "int main(int argc, char **argv) {\n"
+                "    for (int i = 1; i < argc; i++) {\n"
+                "        cs_buffer buf = cs_read_file(argv[i]);\n"
+                '        const char *data = buf.data ? buf.data : "";\n'
+                '        printf("%zu %016llx\\n", buf.len,\n'
+                "               (unsigned long long)cs_hash(data, buf.len));\n"
+                "        free(buf.data);\n"
+                "    }\n"
+                "    return 0;\n"
+                "}\n"
+            )
+            hashes = self._run_program(read_file, *paths[:-3]).splitlines()
+            lines = outputs[0].splitlines()
+            self.assertEqual(lines[0], "rc 0")
+            self.assertEqual([line.split(" ", 1)[1] for line in lines[1:-3]],
+                             [f"{h} 1" for h in hashes])
+            self.assertTrue(all(line.startswith("0 ") for line in lines[1:-3]))
+            self.assertEqual(lines[-3].split()[0], "-2")
+            self.assertEqual(lines[-2].split()[0], "-21")
+            self.assertEqual(lines[-1].split()[:2], ["0", "0"])
+
+    def test_glob_matches_reference_and_prunes_walk(self) -> None:
+        source = (
+            '#include "cs.h"\n'
+            "static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;\n"
+            "static int on_batch(const cs_walk_entry *e, size_t n, void *ctx) {\n"
+            "    (void)ctx;\n"
+            "    pthread_mutex_lock(&lock);\n"
+            "    for (size_t i = 0; i < n; i++) {\n"
+            '        printf("walk %s\\n", e[i].path);\n'
+            "    }\n"
+            "    pthread_mutex_unlock(&lock);\n"
+            "    return 0;\n"
+            "}\n"
+            "int main(int argc, char **argv) {\n"
+            "    size_t count = 0;\n"
+            "    static char paths[4096][64];\n"
+            "    while (count < 4096 && fgets(paths[count], sizeof(paths[0]), stdin)) {\n"
+            "        paths[count][strcspn(paths[count], \"\\n\")] = '\\0';\n"
+            "        count++;\n"
+            "    }\n"
+            "    for (int a = 1; a < argc; a++) {\n"
+            '        if (strncmp(argv[a], "walk:", 5) == 0) {\n'
+            "            cs_glob glob;\n"
+            "            cs_glob_compile(&glob, argv[a] + 5);\n"
+            "            cs_walk_opts opts = {2, 0, 0, 0};\n"
+            '            printf("rc %d\\n", cs_walk_glob("tree", &opts, &glob, on_batch,\n'
+            "                                           NULL));\n"
+            "            cs_glob_free(&glob);\n"
+            "            continue;\n"
+            "        }\n"
+            "        cs_glob glob;\n"
+            "        int rc = cs_glob_compile(&glob, argv[a]);\n"
+            "        if (rc != 0) {\n"
+            '            printf("%d\\n", rc);\n'
+            "            continue;\n"
+            "        }\n"
+            "        for (size_t i = 0; i < count; i++) {\n"
+            "            size_t len = strlen(paths[i]);\n"
+            "            putchar('0' + cs_glob_match(&glob, paths[i], len) +\n"
+            "                    2 * cs_glob_match_dir(&glob, paths[i], len));\n"
+            "        }\n"
+            "        putchar('\\n');\n"
+            "        cs_glob_free(&glob);\n"
+            "    }\n"
+            "    return 0;\n"
+            "}\n"
+        )
+        def expand(pattern):
+            depth, start = 0, None
+            for i, c in enumerate(pattern):
+                if c == "{":
+                    depth += 1
+                    if depth == 1:
+                        start, parts, last = i, [], i + 1
+                elif c == "," and depth == 1:
+                    parts.append(pattern[last:i])
+                    last = i + 1
+                elif c == "}" and depth:
+                    depth -= 1
+                    if depth == 0 and parts:
+                        parts.append(pattern[last:i])
+                        return [x for p in parts
+                                for x in expand(pattern[:start] + p + pattern[i + 1:])]
+            return [pattern]
+
+        def segments(text):
+            segs = text.split("/") if text else []
+            return [s for i, s in enumerate(segs) if s != "**" or i == 0 or segs[i - 1] != "**"]
+
+        def full(p, s):
+            if not p:
+                return not s
+            if p[0] == "**":
+                return any(full(p[1:], s[i:]) for i in range(len(s) + 1))
+            return bool(s) and fnmatchcase(s[0], p[0]) and full(p[1:], s[1:])
+
+        def below(p, s):
+            if not s:
+                return bool(p)
+            if not p:
+                return False
+            if p[0] == "**":
+                return below(p[1:], s) or below(p, s[1:])
+            return fnmatchcase(s[0], p[0]) and below(p[1:], s[1:])
+
+        rng = random.Random(39)
+        names = ["a", "b", "ab", "a.c", "b.h", ".c", "x.tar.c", "cab", ""]
+        paths = sorted({"/".join(rng.choice(names[:-1]) for _ in range(rng.randrange(1, 5)))
+                        for _ in range(300)})
+        tokens = ["a", "b", "c", ".", "*", "?", "[ab]", "[!a]", "[a-c]", "{a,b}", "{a.c,*.h}"]
+        patterns = ["*.c", "**", "**/*.c", "a/**", "a/**/b", "**/a/**/*.c", "**/**/ab", "{a,b}/*"]
+        for _ in range(120):
+            segs = ["**" if rng.random() < 0.2 else
+                    "".join(rng.choice(tokens) for _ in range(rng.randrange(1, 4)))
+                    for _ in range(rng.randrange(1, 4))]
+            patterns.append("/".join(segs))
+
+        out = self._run_program(source, *patterns, stdin="\n".join(paths) + "\n")
+        for pattern, row in zip(patterns, out.splitlines()):
+            alts = [segments(alt) for alt in expand(pattern)]
+            expected = "".join(
+                str(int(any(full(alt, segments(p)) for alt in alts)) +
+                    2 * int(any(below(alt, segments(p)) for alt in alts)))
+                for p in paths
+            )
+            self.assertEqual(row, expected, pattern)
+
+        cases = {
+            r"src/\*.c": ["src/*.c"],
+            "[^.]*.{c,h}": ["main.c", "io.h"],
+            "[]x]": ["]", "x"],
+            "{a,{b,c}}d": ["ad", "bd", "cd"],
+            "[a-]": ["a", "-"],
+            "x{}y": ["x{}y"],
+            "lib[": ["lib["],
+        }
+        probe = ["src/*.c", "src/x.c", "main.c", "io.h", ".c", "]", "x", "ad", "bd", "cd",
+                 "dd", "a", "-", "b", "x{}y", "lib["]
+        out = self._run_program(source, *cases, stdin="\n".join(probe) + "\n")
+        for (pattern, matches), row in zip(cases.items(), out.splitlines()):
+            got = [p for p, bit in zip(probe, row) if int(bit) & 1]
+            self.assertEqual(got, matches, pattern)
+        self.assertEqual(
+            self._run_program(source, "{a,b}" * 9, stdin="x\n"), f"{-7}\n"
+        )
+
+        with tempfile.TemporaryDirectory() as tmp:
+            tree = Path(tmp) / "tree"
+            files = ["main.c", "README", "src/a.c", "src/a.h", "src/deep/b.c",
+                     "vendor/lib/c.c", "vendor/lib/c.h", "docs/x.c"]
+            for name in files:
+                (tree / name).parent.mkdir(parents=True, exist_ok=True)
+                (tree / name).write_text("", encoding="utf-8")
+            out = self._run_program(
+                source, "walk:src/**/*.c", "walk:{src,vendor}/**/*.h", "walk:*", cwd=Path(tmp),
+            )
+            groups = out.split("rc 0\n")
+            self.assertEqual(sorted(groups[0].splitlines()),
+                             ["walk tree/src/a.c", "walk tree/src/deep/b.c"])
+            self.assertEqual(sorted(groups[1].splitlines()),
+                             ["walk tree/src/a.h", "walk tree/vendor/lib/c.h"])
+            self.assertEqual(
+                sorted(groups[2].splitlines()),
+                sorted(f"walk tree/{n}" for n in ["main.c", "README", "src", "vendor", "docs"]),
+            )
+
+    def test_bench_lib_writes_json_report(self) -> None:
+        source = (ROOT / "bench" / "lib.c").read_text(encoding="utf-8")
+        with tempfile.TemporaryDirectory() as tmp:
+            report = Path(tmp) / "lib.json"
+            out = self._run_program(
+                source, "--json", str(report), "--min-ms", "1",
+                "--filter", "cs_{read_file,hash,map_upsert}",
+            )
+            self.assertIn("cs_hash", out)
+            data = json.loads(report.read_text(encoding="utf-8"))
+            cases = [(c["name"], c["dataset"]) for c in data["cases"]]
+            self.assertEqual(
+                cases,
+                [(name, size) for name in ("cs_read_file", "cs_hash")
+                 for size in ("4KiB", "256KiB", "8MiB")]
+                + [("cs_map_upsert", size) for size in ("16", "512", "8192")],
+            )
+            for case in data["cases"]:
+                self.assertGreater(case["ns_per_op"], 0)
+                self.assertGreaterEqual(case["iterations"], 1)
+                self.assertIsNone(case["cycles_per_op"])
+            self.assertGreater(data["cases"][3]["bytes_per_sec"], 0)
+            self.assertIsNone(data["cases"][6]["bytes_per_sec"])
+            if data["allocs_counted"]:
+                self.assertGreaterEqual(data["cases"][0]["allocs_per_op"], 1)
+                self.assertEqual(data["cases"][3]["allocs_per_op"], 0)
+            out = self._run_program(
+                source, "--min-ms", "1", "--filter", "cs_hash/4KiB", "--baseline", str(report),
+            )
+            self.assertRegex(out, r"cs_hash +4KiB .* [0-9.]+x\n")
+
+
+if __name__ == "__main__":
+    unittest.main()